@@ -17,6 +17,7 @@ namespace aoe {
 
 SceneBase::SceneBase(Application& application)
 	: application_(application)
+	, thread_pool_()
 	, world_()
 	, relationeer_(world_)
 	, render_context_(application.GetWindow())
@@ -56,6 +57,7 @@ void SceneBase::PerFrameUpdate(float dt) {
 
 void SceneBase::SetupServices(ServiceProvider& service_provider) {
 	service_provider.AddService(&application_);
+	service_provider.AddService(&thread_pool_);
 	service_provider.AddService(&world_);
 	service_provider.AddService(&relationeer_);
 	service_provider.AddService(&render_context_);
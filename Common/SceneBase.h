@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../Core/ThreadPool.h"
 #include "../Application/Application.h"
 #include "../Game/Relationeer.h"
 #include "../Game/TransformComponent.h"
@@ -31,6 +32,7 @@ protected:
 private:
 	Application& application_;
 
+	ThreadPool thread_pool_;
 	World world_;
 	Relationeer<TransformComponent> relationeer_;
 
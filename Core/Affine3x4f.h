@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Math.h"
+
+namespace aoe {
+
+// Affine transformation with the implicit (0, 0, 0, 1) last row. Rows are
+// stored as is, so it's uploaded to the GPU as row_major float3x4.
+class Affine3x4f {
+public:
+	Affine3x4f()
+		: rows_{
+			{ 1.0f, 0.0f, 0.0f, 0.0f },
+			{ 0.0f, 1.0f, 0.0f, 0.0f },
+			{ 0.0f, 0.0f, 1.0f, 0.0f },
+		}
+	{}
+
+	// Last row of the matrix is dropped.
+	explicit Affine3x4f(const Matrix4f& matrix)
+		: rows_()
+	{
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 4; ++column) {
+				rows_[row][column] = matrix(row, column);
+			}
+		}
+	}
+
+	static Affine3x4f Identity() {
+		return Affine3x4f();
+	}
+
+	// Translation * rotation * scale composed without matrix multiplications.
+	static Affine3x4f FromTRS(const Vector3f& position, const Quaternion& rotation, const Vector3f& scale) {
+		const Vector3f v = rotation.vector();
+		const float w = rotation.scalar();
+		const float xx = 2.0f * v[0] * v[0];
+		const float yy = 2.0f * v[1] * v[1];
+		const float zz = 2.0f * v[2] * v[2];
+		const float xy = 2.0f * v[0] * v[1];
+		const float xz = 2.0f * v[0] * v[2];
+		const float yz = 2.0f * v[1] * v[2];
+		const float xw = 2.0f * v[0] * w;
+		const float yw = 2.0f * v[1] * w;
+		const float zw = 2.0f * v[2] * w;
+
+		Affine3x4f result;
+		result.rows_[0][0] = (1.0f - yy - zz) * scale[0];
+		result.rows_[0][1] = (xy - zw) * scale[1];
+		result.rows_[0][2] = (xz + yw) * scale[2];
+		result.rows_[0][3] = position[0];
+		result.rows_[1][0] = (xy + zw) * scale[0];
+		result.rows_[1][1] = (1.0f - xx - zz) * scale[1];
+		result.rows_[1][2] = (yz - xw) * scale[2];
+		result.rows_[1][3] = position[1];
+		result.rows_[2][0] = (xz - yw) * scale[0];
+		result.rows_[2][1] = (yz + xw) * scale[1];
+		result.rows_[2][2] = (1.0f - xx - yy) * scale[2];
+		result.rows_[2][3] = position[2];
+		return result;
+	}
+
+	float& operator()(int row, int column) {
+		return rows_[row][column];
+	}
+
+	float operator()(int row, int column) const {
+		return rows_[row][column];
+	}
+
+	Vector3f GetTranslation() const {
+		return Vector3f(rows_[0][3], rows_[1][3], rows_[2][3]);
+	}
+
+	Matrix4f ToMatrix4() const {
+		return Matrix4f(
+			rows_[0][0], rows_[1][0], rows_[2][0], 0.0f,
+			rows_[0][1], rows_[1][1], rows_[2][1], 0.0f,
+			rows_[0][2], rows_[1][2], rows_[2][2], 0.0f,
+			rows_[0][3], rows_[1][3], rows_[2][3], 1.0f);
+	}
+
+	Vector3f TransformPoint(const Vector3f& point) const {
+		return TransformDirection(point) + GetTranslation();
+	}
+
+	Vector3f TransformDirection(const Vector3f& direction) const {
+		return Vector3f(
+			rows_[0][0] * direction[0] + rows_[0][1] * direction[1] + rows_[0][2] * direction[2],
+			rows_[1][0] * direction[0] + rows_[1][1] * direction[1] + rows_[1][2] * direction[2],
+			rows_[2][0] * direction[0] + rows_[2][1] * direction[1] + rows_[2][2] * direction[2]);
+	}
+
+	// Transforms the point like the 4x4 matrix does.
+	Vector3f operator*(const Vector3f& point) const {
+		return TransformPoint(point);
+	}
+
+	Affine3x4f operator*(const Affine3x4f& rhs) const {
+		Affine3x4f result;
+
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 4; ++column) {
+				result.rows_[row][column] = rows_[row][0] * rhs.rows_[0][column]
+					+ rows_[row][1] * rhs.rows_[1][column]
+					+ rows_[row][2] * rhs.rows_[2][column];
+			}
+
+			result.rows_[row][3] += rows_[row][3];
+		}
+
+		return result;
+	}
+
+	// Linear part is inverted by cofactors, since global transformations
+	// are sheared under non uniformly scaled parents, and the translation
+	// is rotated back and negated.
+	Affine3x4f Inverse() const {
+		Affine3x4f result = GetNormalMatrix();
+		result.Transpose3x3();
+
+		const Vector3f translation = result.TransformDirection(GetTranslation());
+		result.rows_[0][3] = -translation[0];
+		result.rows_[1][3] = -translation[1];
+		result.rows_[2][3] = -translation[2];
+		return result;
+	}
+
+	// Inverse transpose of the linear part, the translation is zero.
+	Affine3x4f GetNormalMatrix() const {
+		Affine3x4f result;
+
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 3; ++column) {
+				result.rows_[row][column] = GetCofactor(row, column);
+			}
+
+			result.rows_[row][3] = 0.0f;
+		}
+
+		const float determinant = rows_[0][0] * result.rows_[0][0]
+			+ rows_[0][1] * result.rows_[0][1]
+			+ rows_[0][2] * result.rows_[0][2];
+		const float inverse_determinant = 1.0f / determinant;
+
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 3; ++column) {
+				result.rows_[row][column] *= inverse_determinant;
+			}
+		}
+
+		return result;
+	}
+
+private:
+	float rows_[3][4];
+
+	float GetCofactor(int row, int column) const {
+		const int row0 = (row + 1) % 3;
+		const int row1 = (row + 2) % 3;
+		const int column0 = (column + 1) % 3;
+		const int column1 = (column + 2) % 3;
+
+		return rows_[row0][column0] * rows_[row1][column1] - rows_[row0][column1] * rows_[row1][column0];
+	}
+
+	void Transpose3x3() {
+		for (int row = 0; row < 3; ++row) {
+			for (int column = row + 1; column < 3; ++column) {
+				float temp = rows_[row][column];
+				rows_[row][column] = rows_[column][row];
+				rows_[column][row] = temp;
+			}
+		}
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
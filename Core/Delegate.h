@@ -56,6 +56,10 @@ public:
 		return true;
 	}
 
+	bool IsEmpty() const {
+		return handlers_.empty();
+	}
+
 	void Notify(TParams... params) {
 		current_it_ = handlers_.begin();
 		is_detached_ = false;
@@ -17,6 +17,10 @@ public:
 		return delegate_.Detach(object, method);
 	}
 
+	bool IsEmpty() const {
+		return delegate_.IsEmpty();
+	}
+
 protected:
 	void Notify(TParams... params) {
 		delegate_.Notify(params...);
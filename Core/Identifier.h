@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 namespace aoe {
 
 using TypeId = size_t;
@@ -16,7 +18,8 @@ public:
 	}
 
 private:
-	static inline TypeId current_id_ = 0;
+	// Type ids can be requested from different threads.
+	static inline std::atomic<TypeId> current_id_ = 0;
 };
 
 class Identifier : public IdentifierBase<Identifier> {};
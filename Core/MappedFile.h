@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif // !NOMINMAX
+
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif // _WIN32
+
+#include "ClassHelper.h"
+
+namespace aoe {
+
+// Read-only view of the whole file mapped into the memory.
+class MappedFile {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(MappedFile)
+
+public:
+	MappedFile(const std::filesystem::path& path)
+		: data_(nullptr)
+		, size_(0)
+#ifdef _WIN32
+		, file_(INVALID_HANDLE_VALUE)
+		, mapping_(nullptr)
+#endif // _WIN32
+	{
+		Map(path);
+	}
+
+	~MappedFile() {
+		Unmap();
+	}
+
+	bool IsOpen() const {
+		return data_ != nullptr;
+	}
+
+	const std::byte* GetData() const {
+		return data_;
+	}
+
+	size_t GetSize() const {
+		return size_;
+	}
+
+private:
+	const std::byte* data_;
+	size_t size_;
+
+#ifdef _WIN32
+	HANDLE file_;
+	HANDLE mapping_;
+
+	void Map(const std::filesystem::path& path) {
+		file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size{};
+
+		if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+			return;
+		}
+
+		mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping_ == nullptr) {
+			return;
+		}
+
+		data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+		size_ = data_ != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+	}
+
+	void Unmap() {
+		if (data_ != nullptr) {
+			UnmapViewOfFile(data_);
+		}
+
+		if (mapping_ != nullptr) {
+			CloseHandle(mapping_);
+		}
+
+		if (file_ != INVALID_HANDLE_VALUE) {
+			CloseHandle(file_);
+		}
+	}
+#else
+	void Map(const std::filesystem::path& path) {
+		int file = open(path.c_str(), O_RDONLY);
+
+		if (file < 0) {
+			return;
+		}
+
+		struct stat status{};
+
+		if (fstat(file, &status) == 0 && status.st_size > 0) {
+			void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (data != MAP_FAILED) {
+				data_ = static_cast<const std::byte*>(data);
+				size_ = static_cast<size_t>(status.st_size);
+			}
+		}
+
+		close(file);
+	}
+
+	void Unmap() {
+		if (data_ != nullptr) {
+			munmap(const_cast<std::byte*>(data_), size_);
+		}
+	}
+#endif // _WIN32
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ClassHelper.h"
+#include "Debug.h"
+
+namespace aoe {
+
+// Work-stealing thread pool. Every worker owns a queue: it pops own tasks
+// from the back and steals from the front of other queues. Pool without
+// workers is deterministic, tasks run on the calling thread in order.
+class ThreadPool {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(ThreadPool)
+
+public:
+	using Task = std::function<void()>;
+
+	ThreadPool()
+		: ThreadPool(GetDefaultThreadsCount())
+	{}
+
+	ThreadPool(size_t threads_count)
+		: queues_()
+		, threads_()
+		, mutex_()
+		, condition_()
+		, pending_(0)
+		, is_stopped_(false)
+	{
+		// The last queue is shared by threads which aren't workers.
+		for (size_t index = 0; index <= threads_count; ++index) {
+			queues_.push_back(std::make_unique<Queue>());
+		}
+
+		for (size_t index = 0; index < threads_count; ++index) {
+			threads_.emplace_back(&ThreadPool::Work, this, index);
+		}
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_stopped_ = true;
+		}
+
+		condition_.notify_all();
+
+		for (std::thread& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	static size_t GetDefaultThreadsCount() {
+		size_t threads_count = std::thread::hardware_concurrency();
+		return threads_count > 1 ? threads_count - 1 : 0;
+	}
+
+	size_t GetThreadsCount() const {
+		return threads_.size();
+	}
+
+	bool IsDeterministic() const {
+		return threads_.empty();
+	}
+
+	void Submit(Task task) {
+		if (IsDeterministic()) {
+			task();
+			return;
+		}
+
+		Queue& queue = *queues_[GetQueueIndex()];
+
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			pending_ += 1;
+		}
+
+		condition_.notify_one();
+	}
+
+	// Runs pool tasks on the calling thread until the counter reaches zero.
+	void Wait(const std::atomic<size_t>& counter) {
+		while (counter.load(std::memory_order_acquire) > 0) {
+			if (!TryRunTask(GetQueueIndex())) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// Splits [0, size) into batches and calls function(begin, end) for each
+	// of them. Returns when all batches are processed.
+	template<typename TFunction>
+	void ParallelFor(size_t size, size_t batch_size, TFunction function) {
+		AOE_ASSERT_MSG(batch_size > 0, "Invalid batch size.");
+
+		std::atomic<size_t> remaining = (size + batch_size - 1) / batch_size;
+
+		for (size_t begin = 0; begin < size; begin += batch_size) {
+			size_t end = std::min(begin + batch_size, size);
+
+			Submit([&function, &remaining, begin, end]() {
+				function(begin, end);
+				remaining.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		Wait(remaining);
+	}
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	inline static thread_local const ThreadPool* current_pool_ = nullptr;
+	inline static thread_local size_t current_index_ = 0;
+
+	std::vector<std::unique_ptr<Queue>> queues_;
+	std::vector<std::thread> threads_;
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::atomic<size_t> pending_;
+	bool is_stopped_;
+
+	size_t GetQueueIndex() const {
+		return current_pool_ == this ? current_index_ : threads_.size();
+	}
+
+	void Work(size_t index) {
+		current_pool_ = this;
+		current_index_ = index;
+
+		while (true) {
+			if (TryRunTask(index)) {
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return is_stopped_ || pending_ > 0; });
+
+			if (is_stopped_ && pending_ == 0) {
+				return;
+			}
+		}
+	}
+
+	bool TryRunTask(size_t index) {
+		Task task;
+
+		if (!TryPop(index, task) && !TrySteal(index, task)) {
+			return false;
+		}
+
+		pending_ -= 1;
+		task();
+		return true;
+	}
+
+	bool TryPop(size_t index, Task& task) {
+		Queue& queue = *queues_[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty()) {
+			return false;
+		}
+
+		task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		return true;
+	}
+
+	bool TrySteal(size_t index, Task& task) {
+		for (size_t offset = 1; offset < queues_.size(); ++offset) {
+			Queue& queue = *queues_[(index + offset) % queues_.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "pch.h"
+
+#include <atomic>
+#include <vector>
+
+#include "../Core/ThreadPool.h"
+
+namespace aoe_tests {
+namespace core_tests {
+
+TEST(ThreadPoolTests, ParallelFor_ProcessRange_AllIndicesProcessedOnce) {
+	const size_t size = 10000;
+	std::vector<std::atomic<int>> calls(size);
+	aoe::ThreadPool pool(4);
+
+	pool.ParallelFor(size, 64, [&calls](size_t begin, size_t end) {
+		for (size_t index = begin; index < end; ++index) {
+			calls[index] += 1;
+		}
+	});
+
+	for (const std::atomic<int>& count : calls) {
+		ASSERT_EQ(count.load(), 1);
+	}
+}
+
+TEST(ThreadPoolTests, ParallelFor_DeterministicPool_BatchesProcessedInOrder) {
+	std::vector<size_t> begins;
+	aoe::ThreadPool pool(0);
+
+	pool.ParallelFor(100, 10, [&begins](size_t begin, size_t end) {
+		begins.push_back(begin);
+	});
+
+	ASSERT_TRUE(pool.IsDeterministic());
+	ASSERT_EQ(begins.size(), 10);
+
+	for (size_t index = 0; index < begins.size(); ++index) {
+		ASSERT_EQ(begins[index], index * 10);
+	}
+}
+
+TEST(ThreadPoolTests, Submit_SubmitFromTasks_AllTasksDone) {
+	const size_t tasks_count = 100;
+	std::atomic<size_t> remaining = tasks_count * 2;
+	aoe::ThreadPool pool(4);
+
+	for (size_t count = 0; count < tasks_count; ++count) {
+		pool.Submit([&pool, &remaining]() {
+			pool.Submit([&remaining]() {
+				remaining -= 1;
+			});
+
+			remaining -= 1;
+		});
+	}
+
+	pool.Wait(remaining);
+
+	ASSERT_EQ(remaining.load(), 0);
+}
+
+} // namespace core_tests
+} // namespace aoe_tests
\ No newline at end of file
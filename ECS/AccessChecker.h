@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Identifier.h"
+
+namespace aoe {
+
+// Tracks components which are accessed by the alive world views. A component
+// can be read by many views or written by one of them, see WorldView.
+class AccessChecker {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(AccessChecker)
+
+public:
+	AccessChecker()
+		: mutex_()
+		, states_()
+	{}
+
+	bool TryAcquireRead(TypeId type_id) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		State& state = GetState(type_id);
+
+		if (state.is_written) {
+			return false;
+		}
+
+		state.readers_count += 1;
+		return true;
+	}
+
+	bool TryAcquireWrite(TypeId type_id) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		State& state = GetState(type_id);
+
+		if (state.is_written || state.readers_count > 0) {
+			return false;
+		}
+
+		state.is_written = true;
+		return true;
+	}
+
+	void ReleaseRead(TypeId type_id) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		GetState(type_id).readers_count -= 1;
+	}
+
+	void ReleaseWrite(TypeId type_id) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		GetState(type_id).is_written = false;
+	}
+
+private:
+	struct State {
+		size_t readers_count = 0;
+		bool is_written = false;
+	};
+
+	std::mutex mutex_;
+	std::vector<State> states_;
+
+	State& GetState(TypeId type_id) {
+		if (states_.size() <= type_id) {
+			states_.resize(type_id + 1);
+		}
+
+		return states_[type_id];
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
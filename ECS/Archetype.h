@@ -0,0 +1,253 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <new>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Debug.h"
+#include "../Core/Identifier.h"
+
+#include "Entity.h"
+
+namespace aoe {
+
+struct ComponentInfo {
+	using Move = void(*)(void* destination, void* source);
+	using Destroy = void(*)(void* component);
+
+	TypeId type_id;
+	size_t size;
+	size_t alignment;
+	Move move;
+	Destroy destroy;
+
+	template<typename TComponent>
+	static ComponentInfo Create(TypeId type_id) {
+		Move move = [](void* destination, void* source) {
+			TComponent* component = static_cast<TComponent*>(source);
+			new (destination) TComponent(std::move(*component));
+		};
+
+		Destroy destroy = [](void* component) {
+			static_cast<TComponent*>(component)->~TComponent();
+		};
+
+		return { type_id, sizeof(TComponent), alignof(TComponent), move, destroy };
+	}
+};
+
+// Table of entities sharing the same set of components. Rows live in
+// fixed-size chunks, each chunk stores the entities array followed by
+// one array per component.
+class Archetype {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(Archetype)
+
+public:
+	using Signature = std::vector<TypeId>;
+
+	static constexpr size_t kChunkSize = 16 * 1024;
+	static constexpr size_t kChunkAlignment = 64;
+	static constexpr size_t kNoColumn = static_cast<size_t>(-1);
+
+	Archetype(std::vector<ComponentInfo> components)
+		: signature_()
+		, columns_()
+		, chunks_()
+		, capacity_(0)
+		, size_(0)
+		, add_edges_()
+		, remove_edges_()
+	{
+		for (const ComponentInfo& component : components) {
+			signature_.push_back(component.type_id);
+			columns_.push_back({ component, 0 });
+		}
+
+		Layout();
+	}
+
+	~Archetype() {
+		while (size_ > 0) {
+			Remove(size_ - 1);
+		}
+
+		for (std::byte* chunk : chunks_) {
+			::operator delete(chunk, std::align_val_t(kChunkAlignment));
+		}
+	}
+
+	const Signature& GetSignature() const {
+		return signature_;
+	}
+
+	size_t GetSize() const {
+		return size_;
+	}
+
+	size_t GetChunkCapacity() const {
+		return capacity_;
+	}
+
+	size_t GetChunksCount() const {
+		return (size_ + capacity_ - 1) / capacity_;
+	}
+
+	size_t GetChunkSize(size_t chunk) const {
+		AOE_ASSERT_MSG(chunk < GetChunksCount(), "Invalid chunk.");
+		size_t begin = chunk * capacity_;
+		return std::min(capacity_, size_ - begin);
+	}
+
+	size_t FindColumn(TypeId type_id) const {
+		for (size_t column = 0; column < columns_.size(); ++column) {
+			if (columns_[column].info.type_id == type_id) {
+				return column;
+			}
+		}
+
+		return kNoColumn;
+	}
+
+	bool Has(TypeId type_id) const {
+		return FindColumn(type_id) != kNoColumn;
+	}
+
+	const Entity* GetEntities(size_t chunk) const {
+		return reinterpret_cast<const Entity*>(chunks_[chunk]);
+	}
+
+	void* GetColumn(size_t chunk, size_t column) {
+		return chunks_[chunk] + columns_[column].offset;
+	}
+
+	const Entity& GetEntity(size_t row) const {
+		return GetEntities(row / capacity_)[row % capacity_];
+	}
+
+	void* Get(size_t column, size_t row) {
+		AOE_ASSERT_MSG(row < size_, "Invalid row.");
+
+		std::byte* array = static_cast<std::byte*>(GetColumn(row / capacity_, column));
+		return array + (row % capacity_) * columns_[column].info.size;
+	}
+
+	template<typename TComponent>
+	TComponent* Get(size_t column, size_t row) {
+		return static_cast<TComponent*>(Get(column, row));
+	}
+
+	// Reserves a row for the entity, components must be constructed by the caller.
+	size_t Add(Entity entity) {
+		if (size_ == chunks_.size() * capacity_) {
+			void* chunk = ::operator new(kChunkSize, std::align_val_t(kChunkAlignment));
+			chunks_.push_back(static_cast<std::byte*>(chunk));
+		}
+
+		size_t row = size_;
+		size_ += 1;
+
+		new (GetEntityPointer(row)) Entity(entity);
+		return row;
+	}
+
+	// Destroys row components and fills the hole with the last row.
+	// Returns the entity which was moved into the row or null entity.
+	Entity Remove(size_t row) {
+		AOE_ASSERT_MSG(row < size_, "Invalid row.");
+
+		size_t last = size_ - 1;
+
+		for (size_t column = 0; column < columns_.size(); ++column) {
+			const ComponentInfo& info = columns_[column].info;
+			info.destroy(Get(column, row));
+
+			if (row != last) {
+				info.move(Get(column, row), Get(column, last));
+				info.destroy(Get(column, last));
+			}
+		}
+
+		Entity moved = Entity::Null();
+
+		if (row != last) {
+			moved = GetEntity(last);
+			*GetEntityPointer(row) = moved;
+		}
+
+		size_ -= 1;
+		return moved;
+	}
+
+	Archetype* GetAddEdge(TypeId type_id) const {
+		auto it = add_edges_.find(type_id);
+		return it != add_edges_.end() ? it->second : nullptr;
+	}
+
+	void SetAddEdge(TypeId type_id, Archetype* archetype) {
+		add_edges_[type_id] = archetype;
+	}
+
+	Archetype* GetRemoveEdge(TypeId type_id) const {
+		auto it = remove_edges_.find(type_id);
+		return it != remove_edges_.end() ? it->second : nullptr;
+	}
+
+	void SetRemoveEdge(TypeId type_id, Archetype* archetype) {
+		remove_edges_[type_id] = archetype;
+	}
+
+private:
+	struct Column {
+		ComponentInfo info;
+		size_t offset;
+	};
+
+	Signature signature_;
+	std::vector<Column> columns_;
+	std::vector<std::byte*> chunks_;
+	size_t capacity_;
+	size_t size_;
+
+	std::unordered_map<TypeId, Archetype*> add_edges_;
+	std::unordered_map<TypeId, Archetype*> remove_edges_;
+
+	static size_t Align(size_t offset, size_t alignment) {
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	void Layout() {
+		size_t row_size = sizeof(Entity);
+
+		for (const Column& column : columns_) {
+			row_size += column.info.size;
+		}
+
+		for (capacity_ = kChunkSize / row_size; capacity_ > 0; --capacity_) {
+			if (TryLayout()) {
+				return;
+			}
+		}
+
+		AOE_ASSERT_MSG(false, "Components don't fit into the chunk.");
+	}
+
+	bool TryLayout() {
+		size_t offset = sizeof(Entity) * capacity_;
+
+		for (Column& column : columns_) {
+			offset = Align(offset, column.info.alignment);
+			column.offset = offset;
+			offset += column.info.size * capacity_;
+		}
+
+		return offset <= kChunkSize;
+	}
+
+	Entity* GetEntityPointer(size_t row) {
+		return reinterpret_cast<Entity*>(chunks_[row / capacity_]) + row % capacity_;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include "Archetype.h"
+
+namespace aoe {
+
+class ArchetypeStorage {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(ArchetypeStorage)
+
+public:
+	using Archetypes = std::vector<Archetype*>;
+
+	struct Chunk {
+		Archetype* archetype;
+		size_t index;
+	};
+
+	using Chunks = std::vector<Chunk>;
+
+	// Walks entities of the archetypes backward, so moving the current
+	// entity to another archetype only swaps in an already visited one.
+	class Cursor {
+	public:
+		Cursor()
+			: Cursor(nullptr)
+		{}
+
+		Cursor(const Archetypes* archetypes)
+			: archetypes_(archetypes)
+			, archetype_(archetypes != nullptr ? archetypes->size() : 0)
+			, row_(0)
+		{
+			SkipEmpty();
+		}
+
+		Archetype* GetArchetype() const {
+			return (*archetypes_)[archetype_ - 1];
+		}
+
+		size_t GetRow() const {
+			return row_ - 1;
+		}
+
+		const Entity& GetEntity() const {
+			return GetArchetype()->GetEntity(GetRow());
+		}
+
+		void Advance() {
+			row_ = std::min(row_ - 1, GetArchetype()->GetSize());
+
+			if (row_ == 0) {
+				archetype_ -= 1;
+				SkipEmpty();
+			}
+		}
+
+		friend bool operator== (const Cursor& lhs, const Cursor& rhs) {
+			return lhs.archetype_ == rhs.archetype_ && lhs.row_ == rhs.row_;
+		};
+
+		friend bool operator!= (const Cursor& lhs, const Cursor& rhs) {
+			return !(lhs == rhs);
+		};
+
+	private:
+		const Archetypes* archetypes_;
+		size_t archetype_;
+		size_t row_;
+
+		void SkipEmpty() {
+			for (; archetype_ > 0; archetype_ -= 1) {
+				row_ = GetArchetype()->GetSize();
+
+				if (row_ > 0) {
+					return;
+				}
+			}
+
+			row_ = 0;
+		}
+	};
+
+	ArchetypeStorage()
+		: archetypes_()
+		, signatures_()
+		, locations_()
+		, components_()
+	{}
+
+	~ArchetypeStorage() {
+		for (Archetype* archetype : archetypes_) {
+			delete archetype;
+		}
+	}
+
+	template<typename TComponent>
+	bool Has(Entity entity) const {
+		const Location* location = FindLocation(entity);
+
+		if (location == nullptr) {
+			return false;
+		}
+
+		return location->archetype->Has(GetTypeId<TComponent>());
+	}
+
+	template<typename TComponent>
+	TComponent* Get(Entity entity) const {
+		const Location* location = FindLocation(entity);
+
+		if (location == nullptr) {
+			return nullptr;
+		}
+
+		size_t column = location->archetype->FindColumn(GetTypeId<TComponent>());
+
+		if (column == Archetype::kNoColumn) {
+			return nullptr;
+		}
+
+		return location->archetype->Get<TComponent>(column, location->row);
+	}
+
+	template<typename TComponent, typename ...TArgs>
+	void Emplace(Entity entity, TArgs&&... args) {
+		AOE_ASSERT_MSG(!Has<TComponent>(entity), "Try to add an already existing component.");
+
+		TypeId type_id = RegisterComponent<TComponent>();
+		Location& location = GetOrCreateLocation(entity);
+		Archetype* destination = GetAddEdge(location.archetype, type_id);
+
+		Move(entity, location, destination);
+
+		size_t column = destination->FindColumn(type_id);
+		void* component = destination->Get(column, location.row);
+		new (component) TComponent(std::forward<TArgs>(args)...);
+	}
+
+	template<typename TComponent>
+	void Remove(Entity entity) {
+		if (!Has<TComponent>(entity)) {
+			return;
+		}
+
+		Location& location = locations_[entity.GetId()];
+		Archetype* destination = GetRemoveEdge(location.archetype, GetTypeId<TComponent>());
+		Move(entity, location, destination);
+	}
+
+	template<typename ...TComponents>
+	Archetypes GetArchetypes() const {
+		Archetypes archetypes;
+
+		for (Archetype* archetype : archetypes_) {
+			if ((archetype->Has(GetTypeId<TComponents>()) && ...)) {
+				archetypes.push_back(archetype);
+			}
+		}
+
+		return archetypes;
+	}
+
+	Archetypes GetArchetypes(const Archetype::Signature& required, const Archetype::Signature& excluded) const {
+		Archetypes archetypes;
+
+		for (Archetype* archetype : archetypes_) {
+			auto has = [archetype](TypeId type_id) {
+				return archetype->Has(type_id);
+			};
+
+			bool is_matched = std::all_of(required.begin(), required.end(), has)
+				&& std::none_of(excluded.begin(), excluded.end(), has);
+
+			if (is_matched) {
+				archetypes.push_back(archetype);
+			}
+		}
+
+		return archetypes;
+	}
+
+	// Archetypes created by the function are not visited.
+	template<typename ...TComponents, typename TFunction>
+	void ForEach(TFunction function) {
+		for (size_t index = archetypes_.size(); index > 0; --index) {
+			Archetype* archetype = archetypes_[index - 1];
+
+			if (!(archetype->Has(GetTypeId<TComponents>()) && ...)) {
+				continue;
+			}
+
+			for (size_t chunk = archetype->GetChunksCount(); chunk > 0; --chunk) {
+				ForEach<TComponents...>({ archetype, chunk - 1 }, function);
+			}
+		}
+	}
+
+	template<typename ...TComponents>
+	Chunks GetChunks() const {
+		return GetChunks(GetArchetypes<TComponents...>());
+	}
+
+	static Chunks GetChunks(const Archetypes& archetypes) {
+		Chunks chunks;
+
+		for (Archetype* archetype : archetypes) {
+			for (size_t chunk = 0; chunk < archetype->GetChunksCount(); ++chunk) {
+				chunks.push_back({ archetype, chunk });
+			}
+		}
+
+		return chunks;
+	}
+
+	template<typename ...TComponents, typename TFunction>
+	static void ForEach(const Chunk& chunk, TFunction& function) {
+		ForEach<TComponents...>(chunk, function, std::index_sequence_for<TComponents...>());
+	}
+
+	template<typename TComponent>
+	static TypeId GetTypeId() {
+		return ComponentIdentifier::GetTypeId<TComponent>();
+	}
+
+private:
+	class ComponentIdentifier : public IdentifierBase<ComponentIdentifier> {};
+
+	struct Location {
+		Archetype* archetype;
+		size_t row;
+	};
+
+	Archetypes archetypes_;
+	std::map<Archetype::Signature, Archetype*> signatures_;
+	std::vector<Location> locations_;
+	std::vector<ComponentInfo> components_;
+
+	template<typename ...TComponents, typename TFunction, size_t ...TIndices>
+	static void ForEach(const Chunk& chunk, TFunction& function, std::index_sequence<TIndices...>) {
+		Archetype* archetype = chunk.archetype;
+		const Entity* entities = archetype->GetEntities(chunk.index);
+		std::tuple<TComponents*...> arrays = {
+			static_cast<TComponents*>(archetype->GetColumn(
+				chunk.index,
+				archetype->FindColumn(GetTypeId<TComponents>())))...
+		};
+
+		for (size_t row = archetype->GetChunkSize(chunk.index); row > 0; --row) {
+			function(entities[row - 1], std::get<TIndices>(arrays)[row - 1]...);
+		}
+	}
+
+	const Location* FindLocation(Entity entity) const {
+		size_t id = static_cast<size_t>(entity.GetId());
+
+		if (id >= locations_.size() || locations_[id].archetype == nullptr) {
+			return nullptr;
+		}
+
+		return &locations_[id];
+	}
+
+	Location& GetOrCreateLocation(Entity entity) {
+		size_t id = static_cast<size_t>(entity.GetId());
+
+		if (locations_.size() <= id) {
+			locations_.resize(id + 1, { nullptr, 0 });
+		}
+
+		return locations_[id];
+	}
+
+	template<typename TComponent>
+	TypeId RegisterComponent() {
+		TypeId type_id = GetTypeId<TComponent>();
+
+		if (components_.size() <= type_id) {
+			components_.resize(type_id + 1);
+		}
+
+		components_[type_id] = ComponentInfo::Create<TComponent>(type_id);
+		return type_id;
+	}
+
+	// Moves entity components which are present in the destination archetype.
+	void Move(Entity entity, Location& location, Archetype* destination) {
+		Archetype* source = location.archetype;
+		size_t row = 0;
+
+		if (destination != nullptr) {
+			row = destination->Add(entity);
+		}
+
+		if (source != nullptr) {
+			for (TypeId type_id : source->GetSignature()) {
+				size_t to = destination != nullptr ? destination->FindColumn(type_id) : Archetype::kNoColumn;
+
+				if (to != Archetype::kNoColumn) {
+					size_t from = source->FindColumn(type_id);
+					components_[type_id].move(destination->Get(to, row), source->Get(from, location.row));
+				}
+			}
+
+			Entity moved = source->Remove(location.row);
+
+			if (!moved.IsNull()) {
+				locations_[moved.GetId()].row = location.row;
+			}
+		}
+
+		location = { destination, row };
+	}
+
+	Archetype* GetAddEdge(Archetype* source, TypeId type_id) {
+		if (source == nullptr) {
+			return GetOrCreateArchetype({ type_id });
+		}
+
+		Archetype* destination = source->GetAddEdge(type_id);
+
+		if (destination == nullptr) {
+			Archetype::Signature signature = source->GetSignature();
+			signature.insert(std::upper_bound(signature.begin(), signature.end(), type_id), type_id);
+
+			destination = GetOrCreateArchetype(signature);
+			source->SetAddEdge(type_id, destination);
+		}
+
+		return destination;
+	}
+
+	Archetype* GetRemoveEdge(Archetype* source, TypeId type_id) {
+		if (source->GetSignature().size() == 1) {
+			return nullptr;
+		}
+
+		Archetype* destination = source->GetRemoveEdge(type_id);
+
+		if (destination == nullptr) {
+			Archetype::Signature signature = source->GetSignature();
+			signature.erase(std::find(signature.begin(), signature.end(), type_id));
+
+			destination = GetOrCreateArchetype(signature);
+			source->SetRemoveEdge(type_id, destination);
+		}
+
+		return destination;
+	}
+
+	Archetype* GetOrCreateArchetype(const Archetype::Signature& signature) {
+		auto it = signatures_.find(signature);
+
+		if (it != signatures_.end()) {
+			return it->second;
+		}
+
+		std::vector<ComponentInfo> components;
+
+		for (TypeId type_id : signature) {
+			components.push_back(components_[type_id]);
+		}
+
+		Archetype* archetype = new Archetype(std::move(components));
+		archetypes_.push_back(archetype);
+		signatures_[signature] = archetype;
+
+		return archetype;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Identifier.h"
+
+#include "Entity.h"
+
+namespace aoe {
+
+class World;
+
+// Records structural changes to apply them to the world later, see
+// World::Flush. Commands are grouped by component type, sorted by entity
+// and coalesced, so only the last command for the entity takes effect.
+class CommandBuffer {
+AOE_NON_COPYABLE_CLASS(CommandBuffer)
+
+private:
+	friend class World;
+
+public:
+	using Entities = std::vector<Entity>;
+
+	CommandBuffer()
+		: queues_()
+		, created_count_(0)
+		, destroyed_entities_()
+	{}
+
+	CommandBuffer(CommandBuffer&&) = default;
+	CommandBuffer& operator=(CommandBuffer&&) = default;
+
+	bool IsEmpty() const {
+		if (created_count_ > 0 || !destroyed_entities_.empty()) {
+			return false;
+		}
+
+		for (const Queue& queue : queues_) {
+			if (queue.commands != nullptr && !queue.commands->IsEmpty()) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Returns the placeholder, which can be passed to the buffer commands
+	// and becomes the real entity when the buffer is flushed.
+	Entity CreateEntity() {
+		Entity entity(kNullVersion, static_cast<EntityId>(created_count_));
+		created_count_ += 1;
+		return entity;
+	}
+
+	void DestroyEntity(Entity entity) {
+		destroyed_entities_.push_back(entity);
+	}
+
+	template<typename TComponent, typename ...TArgs>
+	void AddComponent(Entity entity, TArgs&&... args) {
+		GetOrCreateCommands<TComponent>().Add(entity, std::forward<TArgs>(args)...);
+	}
+
+	template<typename TComponent>
+	void RemoveComponent(Entity entity) {
+		GetOrCreateCommands<TComponent>().Remove(entity);
+	}
+
+	void Clear() {
+		for (Queue& queue : queues_) {
+			if (queue.commands != nullptr) {
+				queue.commands->Clear();
+			}
+		}
+
+		created_count_ = 0;
+		destroyed_entities_.clear();
+	}
+
+private:
+	class CommandsIdentifier : public IdentifierBase<CommandsIdentifier> {};
+
+	class ICommands {
+	public:
+		virtual ~ICommands() = default;
+		virtual bool IsEmpty() const = 0;
+		virtual void Clear() = 0;
+	};
+
+	template<typename TComponent>
+	class Commands : public ICommands {
+	public:
+		Commands()
+			: commands_()
+			, added_()
+			, removed_()
+			, components_()
+		{}
+
+		bool IsEmpty() const override {
+			return commands_.empty();
+		}
+
+		void Clear() override {
+			commands_.clear();
+		}
+
+		template<typename ...TArgs>
+		void Add(Entity entity, TArgs&&... args) {
+			commands_.push_back({ entity, TComponent(std::forward<TArgs>(args)...) });
+		}
+
+		void Remove(Entity entity) {
+			commands_.push_back({ entity, std::nullopt });
+		}
+
+		template<typename TWorld>
+		static void Apply(ICommands& base, TWorld& world, const Entities& created) {
+			Commands& self = static_cast<Commands&>(base);
+			std::vector<Command>& commands = self.commands_;
+
+			for (Command& command : commands) {
+				command.entity = Resolve(command.entity, created);
+			}
+
+			// Stable sort keeps the recording order of the entity commands.
+			std::stable_sort(commands.begin(), commands.end(), [](const Command& lhs, const Command& rhs) {
+				return lhs.entity.GetId() < rhs.entity.GetId();
+			});
+
+			for (size_t index = 0; index < commands.size(); ++index) {
+				bool is_last = index + 1 == commands.size()
+					|| commands[index + 1].entity.GetId() != commands[index].entity.GetId();
+
+				if (!is_last || !world.IsEntityValid(commands[index].entity)) {
+					continue;
+				}
+
+				if (commands[index].component.has_value()) {
+					self.added_.push_back(commands[index].entity);
+					self.components_.push_back(std::move(*commands[index].component));
+				} else {
+					self.removed_.push_back(commands[index].entity);
+				}
+			}
+
+			commands.clear();
+
+			// Coalesced commands go to the pool in bulk with the batched events.
+			if (!self.removed_.empty()) {
+				world.template RemoveComponents<TComponent>(self.removed_);
+			}
+
+			if (!self.added_.empty()) {
+				world.template AddComponents<TComponent>(self.added_, std::span<TComponent>(self.components_));
+			}
+
+			self.added_.clear();
+			self.removed_.clear();
+			self.components_.clear();
+		}
+
+	private:
+		struct Command {
+			Entity entity;
+			std::optional<TComponent> component;
+		};
+
+		std::vector<Command> commands_;
+		Entities added_;
+		Entities removed_;
+		std::vector<TComponent> components_;
+	};
+
+	struct Queue {
+		using Apply = void(*)(ICommands& commands, World& world, const Entities& created);
+
+		std::unique_ptr<ICommands> commands;
+		Apply apply;
+	};
+
+	std::vector<Queue> queues_;
+	size_t created_count_;
+	Entities destroyed_entities_;
+
+	static bool IsPlaceholder(Entity entity) {
+		return entity.GetVersion() == kNullVersion && entity.GetId() != kNullEntityId;
+	}
+
+	static Entity Resolve(Entity entity, const Entities& created) {
+		return IsPlaceholder(entity) ? created[entity.GetId()] : entity;
+	}
+
+	template<typename TComponent>
+	Commands<TComponent>& GetOrCreateCommands() {
+		TypeId type_id = CommandsIdentifier::GetTypeId<TComponent>();
+
+		if (queues_.size() <= type_id) {
+			queues_.resize(type_id + 1);
+		}
+
+		Queue& queue = queues_[type_id];
+
+		if (queue.commands == nullptr) {
+			queue.commands = std::make_unique<Commands<TComponent>>();
+			queue.apply = &Commands<TComponent>::template Apply<World>;
+		}
+
+		return static_cast<Commands<TComponent>&>(*queue.commands);
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
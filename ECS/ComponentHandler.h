@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "../Core/Debug.h"
 
 #include "ECS.h"
@@ -24,13 +26,19 @@ public:
 			return false;
 		}
 
-		TComponent* component = pool_->Get(entity_);
-		return component != nullptr;
+		return pool_->Has(entity_);
 	}
 
+	// Mutable access marks the component as changed.
 	TComponent* Get() {
+		TComponent* component = const_cast<TComponent*>(std::as_const(*this).Get());
+		pool_->MarkChanged(entity_);
+		return component;
+	}
+
+	const TComponent* Get() const {
 		AOE_ASSERT_MSG(pool_ != nullptr && !entity_.IsNull(), "Handler is invalid.");
-		TComponent* component = pool_->Get(entity_);
+		const TComponent* component = pool_->Get(entity_);
 		AOE_ASSERT_MSG(component != nullptr, "Entity doesn't have a required component.");
 		return component;
 	}
@@ -39,6 +47,10 @@ public:
 		return Get();
 	}
 
+	const TComponent* operator->() const {
+		return Get();
+	}
+
 private:
 	ComponentsPool<TComponent>* pool_;
 	Entity entity_;
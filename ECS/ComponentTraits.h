@@ -0,0 +1,13 @@
+#pragma once
+
+namespace aoe {
+
+// Specialize for the component to change how it's stored.
+template<typename TComponent>
+struct ComponentTraits {
+	// Components keep their addresses until removal, see StableMap.
+	// Archetype storage doesn't support stable components.
+	static constexpr bool kIsStable = false;
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -1,46 +1,259 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <type_traits>
+
 #include "../Core/Event.h"
 
 #include "IComponentsPool.h"
 #include "Entity.h"
 #include "SparseMap.h"
+#include "StableMap.h"
+#include "PagedArray.h"
+#include "ComponentTraits.h"
+#include "ArchetypeStorage.h"
 
 namespace aoe {
 
+template<>
+struct SparseIndex<Entity> {
+	static size_t Get(Entity entity) {
+		return static_cast<size_t>(entity.GetId());
+	}
+};
+
 template<typename TComponent>
 class ComponentsPool : public IComponentsPool {
+private:
+	using Storage = std::conditional_t<
+		ComponentTraits<TComponent>::kIsStable,
+		StableMap<TComponent, Entity>,
+		SparseMap<TComponent, Entity>>;
+
 public:
+	using Entities = typename Storage::Ids;
+	using Iterator = typename Storage::Iterator;
+
 	Event<ComponentsPool, Entity> ComponentAdded;
 	Event<ComponentsPool, Entity> ComponentRemoved;
 
-	ComponentsPool()
+	// Batched operations notify once with all entities, handlers of the
+	// single entity events are still called for every entity.
+	Event<ComponentsPool, std::span<const Entity>> ComponentsAdded;
+	Event<ComponentsPool, std::span<const Entity>> ComponentsRemoved;
+
+	// With archetype storage the pool only keeps events, components live in archetypes.
+	// Components are marked with the current change tick on the mutable access.
+	ComponentsPool(ArchetypeStorage* archetypes = nullptr, const std::atomic<ChangeTick>* change_tick = nullptr)
 		: sparse_map_()
-	{}
+		, archetypes_(archetypes)
+		, change_tick_(change_tick)
+		, changed_ticks_()
+		, last_change_tick_(0)
+		, is_grouped_(false)
+	{
+		AOE_ASSERT_MSG(
+			archetypes_ == nullptr || !ComponentTraits<TComponent>::kIsStable,
+			"Archetype storage doesn't support stable components.");
+	}
+
+	size_t GetSize() const {
+		AssertIsSparseSet();
+		return sparse_map_.GetSize();
+	}
+
+	const Entities& GetEntities() const {
+		AssertIsSparseSet();
+		return sparse_map_.GetIds();
+	}
+
+	// Reserves storage for the size components of entities with ids below the size.
+	void Reserve(size_t size) {
+		if (size == 0) {
+			return;
+		}
+
+		if (archetypes_ == nullptr) {
+			sparse_map_.Reserve(size, Entity(static_cast<EntityId>(size - 1)));
+		}
+
+		changed_ticks_.Reserve(size);
+	}
 
 	bool Has(Entity entity) const override {
-		return sparse_map_.Has(entity.GetId());
+		if (archetypes_ != nullptr) {
+			return archetypes_->Has<TComponent>(entity);
+		}
+
+		return sparse_map_.Has(entity);
 	}
 
 	TComponent* Get(Entity entity) {
-		if (sparse_map_.Has(entity.GetId())) {
-			TComponent& component = sparse_map_.Get(entity.GetId());
+		const ComponentsPool* pool = this;
+		return const_cast<TComponent*>(pool->Get(entity));
+	}
+
+	const TComponent* Get(Entity entity) const {
+		if (archetypes_ != nullptr) {
+			return archetypes_->Get<TComponent>(entity);
+		}
+
+		if (sparse_map_.Has(entity)) {
+			const TComponent& component = sparse_map_.Get(entity);
 			return &component;
 		}
 
 		return nullptr;
 	}
 
+	// Components in the dense order of the entities, see GetEntities.
+	std::span<const TComponent> GetComponents() const {
+		static_assert(!ComponentTraits<TComponent>::kIsStable, "Stable components aren't contiguous.");
+		AssertIsSparseSet();
+		return sparse_map_.GetData();
+	}
+
+	// Mutable access doesn't mark the components as changed, see MarkChanged.
+	std::span<TComponent> GetComponents() {
+		static_assert(!ComponentTraits<TComponent>::kIsStable, "Stable components aren't contiguous.");
+		AssertIsSparseSet();
+		return sparse_map_.GetData();
+	}
+
+	// Dense storage access for the groups, see Group.
+	size_t GetIndex(Entity entity) const {
+		AssertIsSparseSet();
+		return sparse_map_.GetIndex(entity);
+	}
+
+	TComponent& GetByIndex(size_t index) {
+		return sparse_map_.GetByIndex(index);
+	}
+
+	const TComponent& GetByIndex(size_t index) const {
+		return sparse_map_.GetByIndex(index);
+	}
+
+	void Swap(size_t lhs, size_t rhs) {
+		sparse_map_.Swap(lhs, rhs);
+	}
+
+	// Reorders dense storage by the components, compare(lhs, rhs) is a less
+	// predicate. Cheap for the already almost sorted pool, see SortDense.
+	template<typename TCompare>
+	void Sort(TCompare compare) {
+		AssertIsSparseSet();
+		AOE_ASSERT_MSG(!is_grouped_, "Grouped pool is sorted by its group.");
+
+		sparse_map_.Sort([this, &compare](size_t lhs, size_t rhs) {
+			return compare(
+				static_cast<const TComponent&>(sparse_map_.GetByIndex(lhs)),
+				static_cast<const TComponent&>(sparse_map_.GetByIndex(rhs)));
+		});
+	}
+
+	// Reorders dense storage to follow the other pool order. Entities
+	// which aren't in the other pool are moved to the end.
+	template<typename TOther>
+	void SortAs(const ComponentsPool<TOther>& other) {
+		AssertIsSparseSet();
+		AOE_ASSERT_MSG(!is_grouped_, "Grouped pool is sorted by its group.");
+
+		const Entities& entities = sparse_map_.GetIds();
+
+		auto get_rank = [&other](Entity entity) {
+			return other.Has(entity) ? other.GetIndex(entity) : static_cast<size_t>(-1);
+		};
+
+		sparse_map_.Sort([&entities, &get_rank](size_t lhs, size_t rhs) {
+			return get_rank(entities[lhs]) < get_rank(entities[rhs]);
+		});
+	}
+
+	// Moves the entities to the front of dense storage in the given order,
+	// so the components are iterated in lockstep with them.
+	void Arrange(std::span<const Entity> entities) {
+		AssertIsSparseSet();
+		AOE_ASSERT_MSG(!is_grouped_, "Grouped pool is sorted by its group.");
+
+		for (size_t index = 0; index < entities.size(); ++index) {
+			sparse_map_.Swap(index, sparse_map_.GetIndex(entities[index]));
+		}
+	}
+
+	// Dense order of the grouped pool is managed by its group.
+	bool IsGrouped() const {
+		return is_grouped_;
+	}
+
+	void SetGrouped(bool value) {
+		is_grouped_ = value;
+	}
+
+	// Tick of the last mutable access to the existing component.
+	ChangeTick GetChangeTick(Entity entity) const {
+		return changed_ticks_.Get(static_cast<size_t>(entity.GetId()));
+	}
+
+	bool HasChanged(Entity entity, ChangeTick since) const {
+		return GetChangeTick(entity) > since;
+	}
+
+	// Tick of the last mutable access to any component of the pool.
+	ChangeTick GetLastChangeTick() const {
+		return last_change_tick_.load(std::memory_order_relaxed);
+	}
+
+	// Parallel sections mark components with the same tick, so the last tick
+	// is stored only once per section.
+	void MarkChanged(Entity entity) {
+		if (change_tick_ != nullptr) {
+			ChangeTick tick = change_tick_->load(std::memory_order_relaxed);
+			changed_ticks_.At(static_cast<size_t>(entity.GetId())) = tick;
+
+			if (last_change_tick_.load(std::memory_order_relaxed) != tick) {
+				last_change_tick_.store(tick, std::memory_order_relaxed);
+			}
+		}
+	}
+
 	template<typename ...TArgs>
 	void Emplace(Entity entity, TArgs&&... args) {
-		if (sparse_map_.Has(entity.GetId())) {
+		if (Has(entity)) {
 			Remove(entity);
 		}
 
-		sparse_map_.Emplace(entity.GetId(), std::forward<TArgs>(args)...);
+		if (archetypes_ != nullptr) {
+			archetypes_->Emplace<TComponent>(entity, std::forward<TArgs>(args)...);
+		} else {
+			sparse_map_.Emplace(entity, std::forward<TArgs>(args)...);
+		}
+
+		ReserveChangeTicks(entity);
+		MarkChanged(entity);
 		ComponentAdded.Notify(entity);
 	}
 
+	// Adds components constructed from the same arguments to all entities.
+	template<typename ...TArgs>
+	void EmplaceRange(std::span<const Entity> entities, const TArgs&... args) {
+		InsertRange(entities, [&](Entity entity, size_t /*index*/) {
+			Construct(entity, args...);
+		});
+	}
+
+	// Adds components moved from the array, components are paired with entities by index.
+	void AddRange(std::span<const Entity> entities, std::span<TComponent> components) {
+		AOE_ASSERT_MSG(entities.size() == components.size(), "Invalid components count.");
+
+		InsertRange(entities, [&](Entity entity, size_t index) {
+			Construct(entity, std::move(components[index]));
+		});
+	}
+
 	void Add(Entity entity, const TComponent& component) {
 		Emplace(entity, component);
 	}
@@ -50,16 +263,219 @@ public:
 	}
 
 	void Remove(Entity entity) override {
-		if (!sparse_map_.Has(entity.GetId())) {
+		if (!Has(entity)) {
 			return;
 		}
 
 		ComponentRemoved.Notify(entity);
-		sparse_map_.Remove(entity.GetId());
+
+		if (archetypes_ != nullptr) {
+			archetypes_->Remove<TComponent>(entity);
+		} else {
+			sparse_map_.Remove(entity);
+		}
+	}
+
+	// Notifies about the entities which have the component and removes them.
+	void RemoveRange(std::span<const Entity> entities) {
+		std::vector<Entity> removed;
+		removed.reserve(entities.size());
+
+		for (Entity entity : entities) {
+			if (Has(entity)) {
+				removed.push_back(entity);
+			}
+		}
+
+		if (removed.empty()) {
+			return;
+		}
+
+		ComponentsRemoved.Notify(removed);
+
+		if (!ComponentRemoved.IsEmpty()) {
+			for (Entity entity : removed) {
+				ComponentRemoved.Notify(entity);
+			}
+		}
+
+		for (Entity entity : removed) {
+			if (archetypes_ != nullptr) {
+				archetypes_->Remove<TComponent>(entity);
+			} else {
+				sparse_map_.Remove(entity);
+			}
+		}
+	}
+
+	IComponentsPool* CreateEmpty(ArchetypeStorage* archetypes, const std::atomic<ChangeTick>* change_tick) const override {
+		return new ComponentsPool(archetypes, change_tick);
+	}
+
+	void MoveRange(
+		std::span<const Entity> entities,
+		IComponentsPool& destination,
+		std::span<const Entity> destination_entities) override
+	{
+		AOE_ASSERT_MSG(entities.size() == destination_entities.size(), "Invalid entities count.");
+
+		std::vector<Entity> moved;
+		std::vector<Entity> added;
+
+		for (size_t index = 0; index < entities.size(); ++index) {
+			if (Has(entities[index])) {
+				moved.push_back(entities[index]);
+				added.push_back(destination_entities[index]);
+			}
+		}
+
+		if (moved.empty()) {
+			return;
+		}
+
+		if constexpr (std::is_move_constructible_v<TComponent>) {
+			std::vector<TComponent> components;
+			components.reserve(moved.size());
+
+			for (Entity entity : moved) {
+				components.push_back(std::move(*Get(entity)));
+			}
+
+			RemoveRange(moved);
+			static_cast<ComponentsPool&>(destination).AddRange(added, components);
+		} else {
+			AOE_ASSERT_MSG(false, "Can't move not movable components.");
+		}
+	}
+
+	// Copies entities and components in the dense order.
+	std::unique_ptr<IComponentsSnapshot> Snapshot() const override {
+		AssertIsSparseSet();
+
+		if constexpr (std::is_copy_constructible_v<TComponent>) {
+			auto snapshot = std::make_unique<ComponentsSnapshot>();
+			snapshot->entities = sparse_map_.GetIds();
+
+			if constexpr (ComponentTraits<TComponent>::kIsStable) {
+				snapshot->components.reserve(sparse_map_.GetSize());
+
+				for (size_t index = 0; index < sparse_map_.GetSize(); ++index) {
+					snapshot->components.push_back(sparse_map_.GetByIndex(index));
+				}
+			} else {
+				snapshot->components = sparse_map_.GetData();
+			}
+
+			return snapshot;
+		} else {
+			AOE_ASSERT_MSG(sparse_map_.GetSize() == 0, "Can't snapshot not copyable components.");
+			return nullptr;
+		}
+	}
+
+	// Replaces components without notification, restored components are marked as changed.
+	void Restore(const IComponentsSnapshot* snapshot) override {
+		AssertIsSparseSet();
+
+		if (snapshot == nullptr) {
+			sparse_map_.Clear();
+			return;
+		}
+
+		if constexpr (std::is_copy_constructible_v<TComponent>) {
+			const ComponentsSnapshot& components = static_cast<const ComponentsSnapshot&>(*snapshot);
+			Assign(components.entities, components.components);
+		}
+	}
+
+	// Replaces components in bulk without notification, components are marked as changed.
+	void Assign(std::span<const Entity> entities, std::span<const TComponent> components) {
+		AssertIsSparseSet();
+		sparse_map_.Assign(entities, components);
+
+		for (Entity entity : entities) {
+			ReserveChangeTicks(entity);
+			MarkChanged(entity);
+		}
+	}
+
+	Iterator begin() {
+		AssertIsSparseSet();
+		return sparse_map_.begin();
+	}
+
+	Iterator end() {
+		AssertIsSparseSet();
+		return sparse_map_.end();
 	}
 
 private:
-	SparseMap<TComponent> sparse_map_;
+	class ComponentsSnapshot : public IComponentsSnapshot {
+	public:
+		Entities entities;
+		std::vector<TComponent> components;
+	};
+
+	Storage sparse_map_;
+	ArchetypeStorage* archetypes_;
+	const std::atomic<ChangeTick>* change_tick_;
+	PagedArray<ChangeTick, 0> changed_ticks_;
+	std::atomic<ChangeTick> last_change_tick_;
+	bool is_grouped_;
+
+	template<typename ...TArgs>
+	void Construct(Entity entity, TArgs&&... args) {
+		if (archetypes_ != nullptr) {
+			archetypes_->Emplace<TComponent>(entity, std::forward<TArgs>(args)...);
+		} else {
+			sparse_map_.Emplace(entity, std::forward<TArgs>(args)...);
+		}
+	}
+
+	// Constructs components with construct(entity, index) and notifies once.
+	template<typename TConstruct>
+	void InsertRange(std::span<const Entity> entities, TConstruct construct) {
+		if (entities.empty()) {
+			return;
+		}
+
+		Entity last = *std::max_element(entities.begin(), entities.end(), [](Entity lhs, Entity rhs) {
+			return lhs.GetId() < rhs.GetId();
+		});
+
+		for (Entity entity : entities) {
+			if (Has(entity)) {
+				Remove(entity);
+			}
+		}
+
+		if (archetypes_ == nullptr) {
+			sparse_map_.Reserve(sparse_map_.GetSize() + entities.size(), last);
+		}
+
+		for (size_t index = 0; index < entities.size(); ++index) {
+			construct(entities[index], index);
+			ReserveChangeTicks(entities[index]);
+			MarkChanged(entities[index]);
+		}
+
+		ComponentsAdded.Notify(entities);
+
+		if (!ComponentAdded.IsEmpty()) {
+			for (Entity entity : entities) {
+				ComponentAdded.Notify(entity);
+			}
+		}
+	}
+
+	// Allocates the tick page, so the tick can be marked from parallel sections.
+	void ReserveChangeTicks(Entity entity) {
+		changed_ticks_.Set(static_cast<size_t>(entity.GetId()), 0);
+	}
+
+	void AssertIsSparseSet() const {
+		AOE_ASSERT_MSG(archetypes_ == nullptr, "Pool components are stored in archetypes.");
+	}
 };
 
 } // namespace aoe
\ No newline at end of file
@@ -6,8 +6,16 @@ namespace aoe {
 
 using EntityId = int32_t;
 using Version = int32_t;
+using ChangeTick = uint64_t;
 
 const EntityId kNullEntityId = -1;
 const Version kNullVersion = -1;
 
+// Entity is packed into 32 bits, all bits of the field set mean null.
+const uint32_t kEntityIdBits = 22;
+const uint32_t kVersionBits = 10;
+
+const EntityId kMaxEntityId = (1 << kEntityIdBits) - 2;
+const Version kMaxVersion = (1 << kVersionBits) - 2;
+
 } // namespace aoe
\ No newline at end of file
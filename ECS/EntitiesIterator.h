@@ -0,0 +1,57 @@
+#pragma once
+
+#include <iterator>
+#include <vector>
+
+#include "Entity.h"
+
+namespace aoe {
+
+// Walks the entities array backward, so removing the current entity
+// only swaps in an already visited one.
+class EntitiesIterator {
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using difference_type = std::ptrdiff_t;
+	using value_type = Entity;
+	using pointer = const value_type*;
+	using reference = const value_type&;
+
+	EntitiesIterator(const std::vector<Entity>* entities, size_t index)
+		: entities_(entities)
+		, index_(index)
+	{}
+
+	reference operator*() const {
+		return (*entities_)[index_ - 1];
+	}
+
+	pointer operator->() const {
+		return &operator*();
+	}
+
+	EntitiesIterator& operator++() {
+		index_ -= 1;
+		return *this;
+	}
+
+	EntitiesIterator operator++(int) {
+		EntitiesIterator temp = *this;
+		index_ -= 1;
+		return temp;
+	}
+
+	friend bool operator== (const EntitiesIterator& lhs, const EntitiesIterator& rhs) {
+		return lhs.index_ == rhs.index_;
+	};
+
+	friend bool operator!= (const EntitiesIterator& lhs, const EntitiesIterator& rhs) {
+		return !(lhs == rhs);
+	};
+
+private:
+	const std::vector<Entity>* entities_;
+	size_t index_;
+};
+
+} // namespace aoe
\ No newline at end of file
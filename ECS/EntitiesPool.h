@@ -1,11 +1,23 @@
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "Entity.h"
+#include "PagedArray.h"
 
 namespace aoe {
 
+// Copy of the entities pool state, see EntitiesPool::Snapshot.
+struct EntitiesSnapshot {
+	std::vector<Entity> entities;
+	EntityId bound = 0;
+	size_t retired_count = 0;
+};
+
+// Alive entities occupy [0, bound) of the dense array, destroyed ones
+// follow them and are recycled with the next version. Id which version
+// would overflow is retired and never reused.
 class EntitiesPool {
 public:
 	using Iterator = std::vector<Entity>::iterator;
@@ -15,22 +27,36 @@ public:
 		: sparse_()
 		, dense_()
 		, bound_(0)
+		, retired_count_(0)
 	{}
 
 	bool IsValid(Entity entity) const {
-		if (entity.GetId() < 0 || entity.GetId() >= sparse_.size()) {
+		if (entity.GetId() < 0) {
 			return false;
 		}
 
-		Lookup lookup = sparse_[entity.GetId()];
+		Lookup lookup = sparse_.Get(static_cast<size_t>(entity.GetId()));
 
-		if (lookup >= bound_) {
+		if (lookup == kUndefined || lookup >= bound_) {
 			return false;
 		}
 
 		return dense_[lookup].GetVersion() == entity.GetVersion();
 	}
 
+	void Reserve(size_t size) {
+		sparse_.Reserve(size);
+		dense_.reserve(size);
+	}
+
+	size_t GetSize() const {
+		return static_cast<size_t>(bound_);
+	}
+
+	size_t GetRetiredCount() const {
+		return retired_count_;
+	}
+
 	Entity Create() {
 		AOE_ASSERT_MSG(bound_ <= dense_.size(), "Invalid dense bound.");
 
@@ -39,8 +65,11 @@ public:
 		if (bound_ < dense_.size()) {
 			entity = dense_[bound_];
 		} else {
-			sparse_.push_back(bound_);
-			entity = dense_.emplace_back(bound_);
+			size_t id = dense_.size() + retired_count_;
+			AOE_ASSERT_MSG(id <= static_cast<size_t>(kMaxEntityId), "Out of entity ids.");
+
+			sparse_.Set(id, bound_);
+			entity = dense_.emplace_back(static_cast<EntityId>(id));
 		}
 
 		bound_ += 1;
@@ -48,13 +77,45 @@ public:
 	}
 
 	void Destroy(Entity entity) {
+		AOE_ASSERT_MSG(IsValid(entity), "Can't destroy invalid entity.");
 		bound_ -= 1;
 		Entity moved = dense_[bound_];
 
-		std::swap(sparse_[entity.GetId()], sparse_[moved.GetId()]);
+		Lookup& entity_lookup = sparse_.At(static_cast<size_t>(entity.GetId()));
+		Lookup& moved_lookup = sparse_.At(static_cast<size_t>(moved.GetId()));
+		std::swap(entity_lookup, moved_lookup);
+
+		dense_[moved_lookup] = moved;
+		dense_[entity_lookup] = entity;
+
+		if (entity.GetVersion() < kMaxVersion) {
+			dense_[entity_lookup] = { entity.GetVersion() + 1, entity.GetId() };
+		} else {
+			Retire(entity);
+		}
+	}
+
+	EntitiesSnapshot Snapshot() const {
+		return { dense_, bound_, retired_count_ };
+	}
 
-		dense_[sparse_[moved.GetId()]] = moved;
-		dense_[sparse_[entity.GetId()]] = { entity.GetVersion() + 1, entity.GetId() };
+	// Handles of the entities created after the snapshot may become valid again.
+	void Restore(const EntitiesSnapshot& snapshot) {
+		Assign(snapshot.entities, snapshot.bound, snapshot.retired_count);
+	}
+
+	// Replaces the dense array, entities below the bound are alive.
+	void Assign(std::span<const Entity> entities, EntityId bound, size_t retired_count) {
+		AOE_ASSERT_MSG(bound >= 0 && static_cast<size_t>(bound) <= entities.size(), "Invalid dense bound.");
+
+		sparse_.Clear();
+		dense_.assign(entities.begin(), entities.end());
+		bound_ = bound;
+		retired_count_ = retired_count;
+
+		for (size_t index = 0; index < dense_.size(); ++index) {
+			sparse_.Set(static_cast<size_t>(dense_[index].GetId()), static_cast<Lookup>(index));
+		}
 	}
 
 	Iterator begin() {
@@ -76,10 +137,26 @@ public:
 private:
 	using Lookup = EntityId;
 
-	std::vector<Lookup> sparse_;
+	static const Lookup kUndefined = -1;
+
+	PagedArray<Lookup, kUndefined> sparse_;
 	std::vector<Entity> dense_;
 
 	Lookup bound_;
+	size_t retired_count_;
+
+	// Replaces the destroyed entity with the last dense one, so the id leaves the pool.
+	void Retire(Entity entity) {
+		Lookup lookup = sparse_.Get(static_cast<size_t>(entity.GetId()));
+		Entity last = dense_.back();
+
+		dense_[lookup] = last;
+		sparse_.At(static_cast<size_t>(last.GetId())) = lookup;
+		sparse_.At(static_cast<size_t>(entity.GetId())) = kUndefined;
+		dense_.pop_back();
+
+		retired_count_ += 1;
+	}
 };
 
 } // namespace aoe
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
+
 #include "../Core/Debug.h"
 
 #include "ECS.h"
 
 namespace aoe {
 
+// Id and version packed into 32 bits, see kEntityIdBits and kVersionBits.
 class Entity {
 public:
 	static const Version kInitialVersion = 0;
@@ -15,11 +18,10 @@ public:
 	{}
 
 	Entity(Version version, EntityId id)
-		: version_(version)
-		, id_(id)
+		: value_(Pack(version, id))
 	{
-		AOE_ASSERT_MSG(version_ >= kNullVersion, "Invalid version.");
-		AOE_ASSERT_MSG(id_ >= kNullEntityId, "Invalid entity id.");
+		AOE_ASSERT_MSG(version >= kNullVersion && version <= kMaxVersion, "Invalid version.");
+		AOE_ASSERT_MSG(id >= kNullEntityId && id <= kMaxEntityId, "Invalid entity id.");
 	}
 
 	static Entity Null() {
@@ -27,19 +29,25 @@ public:
 	}
 
 	bool IsNull() const {
-		return version_ == kNullVersion && id_ == kNullEntityId;
+		return value_ == kNullValue;
 	}
 
 	Version GetVersion() const {
-		return version_;
+		uint32_t version = value_ >> kEntityIdBits;
+		return version == kVersionMask ? kNullVersion : static_cast<Version>(version);
 	}
 
 	EntityId GetId() const {
-		return id_;
+		uint32_t id = value_ & kEntityIdMask;
+		return id == kEntityIdMask ? kNullEntityId : static_cast<EntityId>(id);
+	}
+
+	uint32_t GetValue() const {
+		return value_;
 	}
-	
+
 	friend bool operator==(const Entity& lhs, const Entity& rhs) {
-		return lhs.version_ == rhs.version_ && lhs.id_ == rhs.id_;
+		return lhs.value_ == rhs.value_;
 	}
 
 	friend bool operator!=(const Entity& lhs, const Entity& rhs) {
@@ -47,10 +55,21 @@ public:
 	}
 
 private:
-	Version version_;
-	EntityId id_;
+	static const uint32_t kEntityIdMask = (1u << kEntityIdBits) - 1;
+	static const uint32_t kVersionMask = (1u << kVersionBits) - 1;
+	static const uint32_t kNullValue = ~0u;
+
+	uint32_t value_;
+
+	static uint32_t Pack(Version version, EntityId id) {
+		uint32_t version_bits = static_cast<uint32_t>(version) & kVersionMask;
+		uint32_t id_bits = static_cast<uint32_t>(id) & kEntityIdMask;
+		return (version_bits << kEntityIdBits) | id_bits;
+	}
 };
 
+static_assert(sizeof(Entity) == sizeof(uint32_t), "Entity must be packed into 32 bits.");
+
 } // namespace aoe
 
 namespace std {
@@ -58,9 +77,7 @@ namespace std {
 	template<>
 	struct hash<aoe::Entity> {
 		size_t operator()(const aoe::Entity& value) const noexcept {
-			size_t hash0 = hash<aoe::Version>()(value.GetVersion());
-			size_t hash1 = hash<aoe::EntityId>()(value.GetId());
-			return hash0 ^ hash1;
+			return hash<uint32_t>()(value.GetValue());
 		}
 	};
 
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Debug.h"
+
+#include "ComponentsPool.h"
+#include "EntitiesIterator.h"
+#include "Terms.h"
+
+namespace aoe {
+
+class IGroup {
+public:
+	virtual ~IGroup() = default;
+	// Rebuilds the group from the pools, see World::Restore.
+	virtual void Reset() = 0;
+};
+
+// Owns the pools and keeps them co-sorted: entities which have all the
+// components occupy the same prefix [0, size) of every pool dense arrays,
+// so the group is iterated in lockstep without lookups. A pool can be
+// owned by one group only.
+template<typename ...TComponents>
+class Group : public IGroup {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(Group)
+
+private:
+	friend class World;
+
+public:
+	using Iterator = EntitiesIterator;
+
+	Group(ComponentsPool<TComponents>*... pools)
+		: pools_(pools...)
+		, size_(0)
+	{
+		AOE_ASSERT_MSG(!(pools->IsGrouped() || ...), "Pool is already owned by the group.");
+		(pools->SetGrouped(true), ...);
+		(pools->ComponentAdded.Attach(*this, &Group::OnComponentAdded), ...);
+		(pools->ComponentRemoved.Attach(*this, &Group::OnComponentRemoved), ...);
+	}
+
+	~Group() override {
+		std::apply([this](auto*... pools) {
+			(pools->SetGrouped(false), ...);
+			(pools->ComponentAdded.Detach(*this, &Group::OnComponentAdded), ...);
+			(pools->ComponentRemoved.Detach(*this, &Group::OnComponentRemoved), ...);
+		}, pools_);
+	}
+
+	size_t GetSize() const {
+		return size_;
+	}
+
+	bool Has(Entity entity) const {
+		auto* pool = std::get<0>(pools_);
+		return pool->Has(entity) && pool->GetIndex(entity) < size_;
+	}
+
+	// Components taken by the function as non-const references are marked as changed.
+	template<typename TFunction>
+	void ForEach(TFunction function) {
+		const std::vector<Entity>& entities = std::get<0>(pools_)->GetEntities();
+
+		for (size_t index = size_; index > 0; --index) {
+			Entity entity = entities[index - 1];
+			function(entity, std::get<ComponentsPool<TComponents>*>(pools_)->GetByIndex(index - 1)...);
+			MarkWrittenTerms<TFunction, TComponents...>(pools_, entity);
+		}
+	}
+
+	void Reset() override {
+		size_ = 0;
+
+		// Group reorders the pools, so the entities are copied.
+		std::vector<Entity> entities = std::get<0>(pools_)->GetEntities();
+
+		for (Entity entity : entities) {
+			OnComponentAdded(entity);
+		}
+	}
+
+	// Reorders the group prefix of all owned pools by the component,
+	// compare(lhs, rhs) is a less predicate, see SortDense.
+	template<typename TComponent, typename TCompare>
+	void Sort(TCompare compare) {
+		auto* pool = std::get<ComponentsPool<TComponent>*>(pools_);
+
+		auto compare_positions = [pool, &compare](size_t lhs, size_t rhs) {
+			return compare(
+				static_cast<const TComponent&>(pool->GetByIndex(lhs)),
+				static_cast<const TComponent&>(pool->GetByIndex(rhs)));
+		};
+
+		SortDense(size_, compare_positions, [this](size_t lhs, size_t rhs) {
+			std::apply([lhs, rhs](auto*... pools) {
+				(pools->Swap(lhs, rhs), ...);
+			}, pools_);
+		});
+	}
+
+	Iterator begin() const {
+		return { &std::get<0>(pools_)->GetEntities(), size_ };
+	}
+
+	Iterator end() const {
+		return { &std::get<0>(pools_)->GetEntities(), 0 };
+	}
+
+private:
+	std::tuple<ComponentsPool<TComponents>*...> pools_;
+	size_t size_;
+
+	// Added component is already in the pool.
+	void OnComponentAdded(Entity entity) {
+		bool is_matched = std::apply([entity](auto*... pools) {
+			return (pools->Has(entity) && ...);
+		}, pools_);
+
+		if (is_matched && !Has(entity)) {
+			Add(entity);
+		}
+	}
+
+	// Removed component is still in the pool, moving it out of the prefix
+	// keeps the prefix intact after the pool swap-and-pop removal.
+	void OnComponentRemoved(Entity entity) {
+		if (!Has(entity)) {
+			return;
+		}
+
+		size_ -= 1;
+
+		std::apply([this, entity](auto*... pools) {
+			(pools->Swap(pools->GetIndex(entity), size_), ...);
+		}, pools_);
+	}
+
+	void Add(Entity entity) {
+		std::apply([this, entity](auto*... pools) {
+			(pools->Swap(pools->GetIndex(entity), size_), ...);
+		}, pools_);
+
+		size_ += 1;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -1,14 +1,35 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <span>
+
 #include "Entity.h"
 
 namespace aoe {
 
+class ArchetypeStorage;
+
+class IComponentsSnapshot {
+public:
+	virtual ~IComponentsSnapshot() = default;
+};
+
 class IComponentsPool {
 public:
 	virtual ~IComponentsPool() = default;
 	virtual bool Has(Entity entity) const = 0;
 	virtual void Remove(Entity entity) = 0;
+	// Empty pool of the same components.
+	virtual IComponentsPool* CreateEmpty(ArchetypeStorage* archetypes, const std::atomic<ChangeTick>* change_tick) const = 0;
+	// Moves components to the same components pool, entities are paired with the destination ones by index.
+	virtual void MoveRange(
+		std::span<const Entity> entities,
+		IComponentsPool& destination,
+		std::span<const Entity> destination_entities) = 0;
+	virtual std::unique_ptr<IComponentsSnapshot> Snapshot() const = 0;
+	// Null snapshot clears the pool.
+	virtual void Restore(const IComponentsSnapshot* snapshot) = 0;
 };
 
 } // namespace aoe
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Debug.h"
+
+namespace aoe {
+
+// Array of fixed-size pages allocated on the first write. Missing pages
+// refer to the shared page filled with the null value, so memory scales
+// with the occupied pages and growth only copies page pointers.
+template<typename TValue, TValue kNull, size_t kPageSize = 4096>
+class PagedArray {
+AOE_NON_COPYABLE_CLASS(PagedArray)
+
+public:
+	PagedArray()
+		: pages_()
+	{}
+
+	PagedArray(PagedArray&& other) noexcept
+		: pages_(std::move(other.pages_))
+	{
+		other.pages_.clear();
+	}
+
+	PagedArray& operator=(PagedArray&& other) noexcept {
+		if (this != &other) {
+			Clear();
+			pages_ = std::move(other.pages_);
+			other.pages_.clear();
+		}
+
+		return *this;
+	}
+
+	~PagedArray() {
+		Clear();
+	}
+
+	// Number of addressable values, includes the values of null pages.
+	size_t GetSize() const {
+		return pages_.size() * kPageSize;
+	}
+
+	void Reserve(size_t size) {
+		pages_.reserve((size + kPageSize - 1) / kPageSize);
+	}
+
+	TValue Get(size_t index) const {
+		size_t page = index / kPageSize;
+		return page < pages_.size() ? pages_[page][index % kPageSize] : kNull;
+	}
+
+	// Value in the allocated page, see Set.
+	TValue& At(size_t index) {
+		size_t page = index / kPageSize;
+		AOE_ASSERT_MSG(page < pages_.size() && pages_[page] != GetNullPage(), "Page isn't allocated.");
+		return pages_[page][index % kPageSize];
+	}
+
+	void Set(size_t index, TValue value) {
+		size_t page = index / kPageSize;
+
+		if (pages_.size() <= page) {
+			pages_.resize(page + 1, GetNullPage());
+		}
+
+		if (pages_[page] == GetNullPage()) {
+			pages_[page] = new TValue[kPageSize];
+			std::fill(pages_[page], pages_[page] + kPageSize, kNull);
+		}
+
+		pages_[page][index % kPageSize] = value;
+	}
+
+	void Clear() {
+		for (TValue* page : pages_) {
+			if (page != GetNullPage()) {
+				delete[] page;
+			}
+		}
+
+		pages_.clear();
+	}
+
+private:
+	std::vector<TValue*> pages_;
+
+	// Never written, writes allocate own page first.
+	static TValue* GetNullPage() {
+		static std::array<TValue, kPageSize> page = []() {
+			std::array<TValue, kPageSize> values;
+			values.fill(kNull);
+			return values;
+		}();
+
+		return page.data();
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+
+#include "ComponentsPool.h"
+#include "EntitiesIterator.h"
+#include "PagedArray.h"
+
+namespace aoe {
+
+class IQuery {
+public:
+	virtual ~IQuery() = default;
+	// Rebuilds the query from the pools, see World::Restore.
+	virtual void Reset() = 0;
+};
+
+// Persistent list of the entities which have all the components. The list
+// is updated from the pools events, so iteration doesn't probe the pools.
+template<typename ...TComponents>
+class Query : public IQuery {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(Query)
+
+private:
+	friend class World;
+
+public:
+	using Entities = std::vector<Entity>;
+	using Iterator = EntitiesIterator;
+
+	Query(ComponentsPool<TComponents>*... pools)
+		: pools_(pools...)
+		, sparse_()
+		, entities_()
+	{
+		(pools->ComponentAdded.Attach(*this, &Query::OnComponentAdded), ...);
+		(pools->ComponentRemoved.Attach(*this, &Query::OnComponentRemoved), ...);
+	}
+
+	~Query() override {
+		std::apply([this](auto*... pools) {
+			(pools->ComponentAdded.Detach(*this, &Query::OnComponentAdded), ...);
+			(pools->ComponentRemoved.Detach(*this, &Query::OnComponentRemoved), ...);
+		}, pools_);
+	}
+
+	size_t GetSize() const {
+		return entities_.size();
+	}
+
+	bool IsEmpty() const {
+		return entities_.empty();
+	}
+
+	const Entities& GetEntities() const {
+		return entities_;
+	}
+
+	bool Has(Entity entity) const {
+		Lookup lookup = sparse_.Get(static_cast<size_t>(entity.GetId()));
+		return lookup != kUndefined && entities_[lookup] == entity;
+	}
+
+	void Reset() override {
+		sparse_.Clear();
+		entities_.clear();
+
+		for (Entity entity : std::get<0>(pools_)->GetEntities()) {
+			OnComponentAdded(entity);
+		}
+	}
+
+	Iterator begin() const {
+		return { &entities_, entities_.size() };
+	}
+
+	Iterator end() const {
+		return { &entities_, 0 };
+	}
+
+private:
+	using Lookup = int32_t;
+
+	static const Lookup kUndefined = -1;
+
+	std::tuple<ComponentsPool<TComponents>*...> pools_;
+	PagedArray<Lookup, kUndefined> sparse_;
+	Entities entities_;
+
+	// Added component is already in the pool.
+	void OnComponentAdded(Entity entity) {
+		bool is_matched = std::apply([entity](auto*... pools) {
+			return (pools->Has(entity) && ...);
+		}, pools_);
+
+		if (is_matched && !Has(entity)) {
+			Add(entity);
+		}
+	}
+
+	// Removed component is still in the pool.
+	void OnComponentRemoved(Entity entity) {
+		if (!Has(entity)) {
+			return;
+		}
+
+		size_t index = static_cast<size_t>(entity.GetId());
+		Lookup lookup = sparse_.Get(index);
+		Entity moved = entities_.back();
+
+		entities_[lookup] = moved;
+		sparse_.At(static_cast<size_t>(moved.GetId())) = lookup;
+		sparse_.At(index) = kUndefined;
+		entities_.pop_back();
+	}
+
+	void Add(Entity entity) {
+		sparse_.Set(static_cast<size_t>(entity.GetId()), static_cast<Lookup>(entities_.size()));
+		entities_.push_back(entity);
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
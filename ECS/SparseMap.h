@@ -1,63 +1,211 @@
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "../Core/Debug.h"
 
+#include "PagedArray.h"
+
 namespace aoe {
 
-template<typename TData>
+template<typename TId>
+struct SparseIndex {
+	static size_t Get(TId id) {
+		return static_cast<size_t>(id);
+	}
+};
+
+// Sorts [0, size) with the swap function, compare takes positions. Almost
+// sorted range is insertion sorted, otherwise sorting permutation is built
+// and applied. Both are stable.
+template<typename TCompare, typename TSwap>
+void SortDense(size_t size, TCompare compare, TSwap swap) {
+	static constexpr size_t kMaxDescents = 32;
+
+	size_t descents = 0;
+
+	for (size_t index = 1; index < size && descents <= kMaxDescents; ++index) {
+		if (compare(index, index - 1)) {
+			descents += 1;
+		}
+	}
+
+	if (descents == 0) {
+		return;
+	}
+
+	if (descents <= kMaxDescents) {
+		for (size_t index = 1; index < size; ++index) {
+			for (size_t current = index; current > 0 && compare(current, current - 1); --current) {
+				swap(current, current - 1);
+			}
+		}
+
+		return;
+	}
+
+	std::vector<size_t> order(size);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), compare);
+
+	// Position receives the element from order[position], cycles are closed by swaps.
+	for (size_t index = 0; index < size; ++index) {
+		size_t current = index;
+
+		while (order[current] != index) {
+			size_t next = order[current];
+			swap(current, next);
+			order[current] = current;
+			current = next;
+		}
+
+		order[current] = current;
+	}
+}
+
+template<typename TData, typename TId = size_t>
 class SparseMap {
 public:
-	using Id = size_t;
+	using Id = TId;
+	using Ids = std::vector<Id>;
+
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = std::pair<Id, TData&>;
+		using reference = value_type;
+
+		Iterator()
+			: Iterator(nullptr, 0)
+		{}
+
+		Iterator(SparseMap* sparse_map, size_t index)
+			: sparse_map_(sparse_map)
+			, index_(index)
+		{}
+
+		reference operator*() const {
+			return { sparse_map_->ids_[index_ - 1], sparse_map_->data_[index_ - 1] };
+		}
+
+		Iterator& operator++() {
+			index_ -= 1;
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			Iterator temp = *this;
+			index_ -= 1;
+			return temp;
+		}
+
+		friend bool operator== (const Iterator& lhs, const Iterator& rhs) {
+			return lhs.index_ == rhs.index_;
+		};
+
+		friend bool operator!= (const Iterator& lhs, const Iterator& rhs) {
+			return lhs.index_ != rhs.index_;
+		};
+
+	private:
+		SparseMap* sparse_map_;
+		size_t index_;
+	};
 
 	SparseMap()
 		: sparse_()
-		, dense_()
-		, bound_(0)
+		, ids_()
+		, data_()
 	{}
 
-	bool Has(Id id) const {
-		if (id < 0 || id >= sparse_.size()) {
-			return false;
-		}
+	size_t GetSize() const {
+		return ids_.size();
+	}
 
-		Lookup lookup = sparse_[id];
-		return lookup != kUndefined;
+	const Ids& GetIds() const {
+		return ids_;
+	}
+
+	std::span<TData> GetData() {
+		return data_;
+	}
+
+	const std::vector<TData>& GetData() const {
+		return data_;
+	}
+
+	// Reserves dense storage for the size and sparse storage for the id.
+	void Reserve(size_t size, Id id) {
+		ids_.reserve(size);
+		data_.reserve(size);
+		sparse_.Reserve(SparseIndex<Id>::Get(id) + 1);
+	}
+
+	bool Has(Id id) const {
+		return sparse_.Get(SparseIndex<Id>::Get(id)) != kUndefined;
 	}
 
 	TData& Get(Id id) {
 		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
 
-		Lookup lookup = sparse_[id];
-		return dense_[lookup].data;
+		Lookup lookup = sparse_.Get(SparseIndex<Id>::Get(id));
+		return data_[lookup];
 	}
 
 	const TData& Get(Id id) const {
 		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
 
-		Lookup lookup = sparse_[id];
-		return dense_[lookup].data;
+		Lookup lookup = sparse_.Get(SparseIndex<Id>::Get(id));
+		return data_[lookup];
 	}
 
-	template<typename ...TArgs>
-	void Emplace(Id id, TArgs&&... args) {
-		AOE_ASSERT_MSG(!Has(id), "Try to add an already existing id.");
-		AOE_ASSERT_MSG(bound_ <= dense_.size(), "Invalid dense bound.");
+	// Index of the id in the dense arrays.
+	size_t GetIndex(Id id) const {
+		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
+		return static_cast<size_t>(sparse_.Get(SparseIndex<Id>::Get(id)));
+	}
 
-		if (sparse_.size() <= id) {
-			sparse_.resize(id + 1, kUndefined);
-		}
+	TData& GetByIndex(size_t index) {
+		return data_[index];
+	}
 
-		if (bound_ < dense_.size()) {
-			dense_[bound_] = { id, std::forward<TArgs>(args)... };
-		}
-		else {
-			dense_.emplace_back(id, std::forward<TArgs>(args)...);
+	const TData& GetByIndex(size_t index) const {
+		return data_[index];
+	}
+
+	// Swaps dense positions of two ids.
+	void Swap(size_t lhs, size_t rhs) {
+		if (lhs == rhs) {
+			return;
 		}
 
-		sparse_[id] = bound_;
-		bound_ += 1;
+		std::swap(ids_[lhs], ids_[rhs]);
+		std::swap(data_[lhs], data_[rhs]);
+		sparse_.At(SparseIndex<Id>::Get(ids_[lhs])) = static_cast<Lookup>(lhs);
+		sparse_.At(SparseIndex<Id>::Get(ids_[rhs])) = static_cast<Lookup>(rhs);
+	}
+
+	// Sorts dense arrays, compare takes dense positions, see SortDense.
+	template<typename TCompare>
+	void Sort(TCompare compare) {
+		SortDense(ids_.size(), compare, [this](size_t lhs, size_t rhs) {
+			Swap(lhs, rhs);
+		});
+	}
+
+	template<typename ...TArgs>
+	void Emplace(Id id, TArgs&&... args) {
+		AOE_ASSERT_MSG(!Has(id), "Try to add an already existing id.");
+		AOE_ASSERT_MSG(ids_.size() == data_.size(), "Invalid dense size.");
+
+		sparse_.Set(SparseIndex<Id>::Get(id), static_cast<Lookup>(ids_.size()));
+		ids_.push_back(id);
+		data_.emplace_back(std::forward<TArgs>(args)...);
 	}
 
 	void Add(Id id, const TData& data) {
@@ -73,37 +221,60 @@ public:
 			return;
 		}
 
-		bound_ -= 1;
+		size_t index = SparseIndex<Id>::Get(id);
+		Lookup lookup = sparse_.Get(index);
+		Lookup last = static_cast<Lookup>(ids_.size()) - 1;
 
-		Lookup lookup = sparse_[id];
-		Id moved = dense_[bound_].id;
+		if (lookup != last) {
+			Id moved = ids_[last];
 
-		std::swap(dense_[lookup], dense_[bound_]);
+			ids_[lookup] = moved;
+			data_[lookup] = std::move(data_[last]);
+			sparse_.At(SparseIndex<Id>::Get(moved)) = lookup;
+		}
 
-		sparse_[moved] = lookup;
-		sparse_[id] = kUndefined;
+		sparse_.At(index) = kUndefined;
+		ids_.pop_back();
+		data_.pop_back();
 	}
 
-private:
-	struct Node {
-		Id id;
-		TData data;
-
-		template<typename ...TArgs>
-		Node(Id id, TArgs&&... args)
-			: id(id)
-			, data(std::forward<TArgs>(args)...)
-		{}
-	};
+	// Replaces the content with the ids and the data in the same order.
+	void Assign(std::span<const Id> ids, std::span<const TData> data) {
+		AOE_ASSERT_MSG(ids.size() == data.size(), "Invalid dense size.");
+
+		Clear();
+		ids_.assign(ids.begin(), ids.end());
+		data_.assign(data.begin(), data.end());
+
+		for (size_t index = 0; index < ids_.size(); ++index) {
+			sparse_.Set(SparseIndex<Id>::Get(ids_[index]), static_cast<Lookup>(index));
+		}
+	}
+
+	void Clear() {
+		sparse_.Clear();
+		ids_.clear();
+		data_.clear();
+	}
+
+	// Dense storage is walked backward, so removing the current id
+	// only swaps in an already visited one.
+	Iterator begin() {
+		return { this, ids_.size() };
+	}
+
+	Iterator end() {
+		return { this, 0 };
+	}
 
+private:
 	using Lookup = int32_t;
 
 	static const Lookup kUndefined = -1;
 
-	std::vector<Lookup> sparse_;
-	std::vector<Node> dense_;
-
-	Lookup bound_;
+	PagedArray<Lookup, kUndefined> sparse_;
+	Ids ids_;
+	std::vector<TData> data_;
 };
 
 } // namespace aoe
\ No newline at end of file
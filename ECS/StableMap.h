@@ -0,0 +1,271 @@
+#pragma once
+
+#include <new>
+#include <span>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Debug.h"
+
+#include "PagedArray.h"
+#include "SparseMap.h"
+
+namespace aoe {
+
+// Sparse map which never moves the data. Data lives in fixed-size blocks,
+// slots of the removed data are reused through the free list. Dense arrays
+// only keep ids and pointers, so removal swaps pointers instead of data.
+template<typename TData, typename TId = size_t>
+class StableMap {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(StableMap)
+
+public:
+	using Id = TId;
+	using Ids = std::vector<Id>;
+
+	static constexpr size_t kBlockSize = 1024;
+
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = std::pair<Id, TData&>;
+		using reference = value_type;
+
+		Iterator()
+			: Iterator(nullptr, 0)
+		{}
+
+		Iterator(StableMap* stable_map, size_t index)
+			: stable_map_(stable_map)
+			, index_(index)
+		{}
+
+		reference operator*() const {
+			return { stable_map_->ids_[index_ - 1], *stable_map_->data_[index_ - 1] };
+		}
+
+		Iterator& operator++() {
+			index_ -= 1;
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			Iterator temp = *this;
+			index_ -= 1;
+			return temp;
+		}
+
+		friend bool operator== (const Iterator& lhs, const Iterator& rhs) {
+			return lhs.index_ == rhs.index_;
+		};
+
+		friend bool operator!= (const Iterator& lhs, const Iterator& rhs) {
+			return lhs.index_ != rhs.index_;
+		};
+
+	private:
+		StableMap* stable_map_;
+		size_t index_;
+	};
+
+	StableMap()
+		: sparse_()
+		, ids_()
+		, data_()
+		, blocks_()
+		, block_size_(kBlockSize)
+		, free_()
+	{}
+
+	~StableMap() {
+		Clear();
+	}
+
+	size_t GetSize() const {
+		return ids_.size();
+	}
+
+	const Ids& GetIds() const {
+		return ids_;
+	}
+
+	// Reserves dense arrays for the size and sparse storage for the id.
+	void Reserve(size_t size, Id id) {
+		ids_.reserve(size);
+		data_.reserve(size);
+		sparse_.Reserve(SparseIndex<Id>::Get(id) + 1);
+	}
+
+	bool Has(Id id) const {
+		return sparse_.Get(SparseIndex<Id>::Get(id)) != kUndefined;
+	}
+
+	TData& Get(Id id) {
+		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
+
+		Lookup lookup = sparse_.Get(SparseIndex<Id>::Get(id));
+		return *data_[lookup];
+	}
+
+	const TData& Get(Id id) const {
+		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
+
+		Lookup lookup = sparse_.Get(SparseIndex<Id>::Get(id));
+		return *data_[lookup];
+	}
+
+	// Index of the id in the dense arrays.
+	size_t GetIndex(Id id) const {
+		AOE_ASSERT_MSG(Has(id), "Try get no existing id.");
+		return static_cast<size_t>(sparse_.Get(SparseIndex<Id>::Get(id)));
+	}
+
+	TData& GetByIndex(size_t index) {
+		return *data_[index];
+	}
+
+	const TData& GetByIndex(size_t index) const {
+		return *data_[index];
+	}
+
+	// Swaps dense positions of two ids.
+	void Swap(size_t lhs, size_t rhs) {
+		if (lhs == rhs) {
+			return;
+		}
+
+		std::swap(ids_[lhs], ids_[rhs]);
+		std::swap(data_[lhs], data_[rhs]);
+		sparse_.At(SparseIndex<Id>::Get(ids_[lhs])) = static_cast<Lookup>(lhs);
+		sparse_.At(SparseIndex<Id>::Get(ids_[rhs])) = static_cast<Lookup>(rhs);
+	}
+
+	// Sorts dense arrays, compare takes dense positions, see SortDense.
+	template<typename TCompare>
+	void Sort(TCompare compare) {
+		SortDense(ids_.size(), compare, [this](size_t lhs, size_t rhs) {
+			Swap(lhs, rhs);
+		});
+	}
+
+	template<typename ...TArgs>
+	void Emplace(Id id, TArgs&&... args) {
+		AOE_ASSERT_MSG(!Has(id), "Try to add an already existing id.");
+		AOE_ASSERT_MSG(ids_.size() == data_.size(), "Invalid dense size.");
+
+		TData* data = new (AllocateSlot()) TData(std::forward<TArgs>(args)...);
+
+		sparse_.Set(SparseIndex<Id>::Get(id), static_cast<Lookup>(ids_.size()));
+		ids_.push_back(id);
+		data_.push_back(data);
+	}
+
+	void Add(Id id, const TData& data) {
+		Emplace(id, data);
+	}
+
+	void Add(Id id, TData&& data) {
+		Emplace(id, std::move(data));
+	}
+
+	void Remove(Id id) {
+		if (!Has(id)) {
+			return;
+		}
+
+		size_t index = SparseIndex<Id>::Get(id);
+		Lookup lookup = sparse_.Get(index);
+		Lookup last = static_cast<Lookup>(ids_.size()) - 1;
+		TData* data = data_[lookup];
+
+		data->~TData();
+		free_.push_back(data);
+
+		if (lookup != last) {
+			Id moved = ids_[last];
+
+			ids_[lookup] = moved;
+			data_[lookup] = data_[last];
+			sparse_.At(SparseIndex<Id>::Get(moved)) = lookup;
+		}
+
+		sparse_.At(index) = kUndefined;
+		ids_.pop_back();
+		data_.pop_back();
+	}
+
+	// Replaces the content with the ids and the data in the same order.
+	void Assign(std::span<const Id> ids, std::span<const TData> data) {
+		AOE_ASSERT_MSG(ids.size() == data.size(), "Invalid dense size.");
+
+		Clear();
+		ids_.reserve(ids.size());
+		data_.reserve(data.size());
+
+		for (size_t index = 0; index < ids.size(); ++index) {
+			Emplace(ids[index], data[index]);
+		}
+	}
+
+	// Destroys the data and releases the blocks.
+	void Clear() {
+		for (TData* data : data_) {
+			data->~TData();
+		}
+
+		for (TData* block : blocks_) {
+			::operator delete(block, std::align_val_t(alignof(TData)));
+		}
+
+		sparse_.Clear();
+		ids_.clear();
+		data_.clear();
+		blocks_.clear();
+		block_size_ = kBlockSize;
+		free_.clear();
+	}
+
+	// Dense storage is walked backward, so removing the current id
+	// only swaps in an already visited one.
+	Iterator begin() {
+		return { this, ids_.size() };
+	}
+
+	Iterator end() {
+		return { this, 0 };
+	}
+
+private:
+	using Lookup = int32_t;
+
+	static const Lookup kUndefined = -1;
+
+	PagedArray<Lookup, kUndefined> sparse_;
+	Ids ids_;
+	std::vector<TData*> data_;
+
+	std::vector<TData*> blocks_;
+	size_t block_size_;
+	std::vector<TData*> free_;
+
+	void* AllocateSlot() {
+		if (!free_.empty()) {
+			TData* slot = free_.back();
+			free_.pop_back();
+			return slot;
+		}
+
+		if (block_size_ == kBlockSize) {
+			void* block = ::operator new(sizeof(TData) * kBlockSize, std::align_val_t(alignof(TData)));
+			blocks_.push_back(static_cast<TData*>(block));
+			block_size_ = 0;
+		}
+
+		TData* slot = blocks_.back() + block_size_;
+		block_size_ += 1;
+		return slot;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+
+#include "ComponentsPool.h"
+
+namespace aoe {
+
+// Matches entities whose component was mutably accessed after the tick
+// passed to the query.
+template<typename TComponent>
+struct Changed {};
+
+// Matches entities which don't have the component.
+template<typename TComponent>
+struct Without {};
+
+// Doesn't affect matching, the function gets the component pointer
+// or nullptr if the entity doesn't have the component.
+template<typename TComponent>
+struct Optional {};
+
+// Describes the query term: the component it refers to, whether the
+// component is required, the extra condition on the component and the
+// arguments passed to the query function.
+template<typename TTerm>
+struct Term {
+	using Component = TTerm;
+	using Arguments = std::tuple<Component&>;
+	using ConstArguments = std::tuple<const Component&>;
+
+	static constexpr bool kIsRequired = true;
+	static constexpr bool kIsChecked = false;
+
+	// Pool of the not required component may be null.
+	static bool Match(const ComponentsPool<Component>* /*pool*/, Entity /*entity*/, ChangeTick /*since*/) {
+		return true;
+	}
+
+	static Arguments GetArguments(ComponentsPool<Component>* pool, Entity entity) {
+		return { *pool->Get(entity) };
+	}
+};
+
+template<typename TComponent>
+struct Term<Changed<TComponent>> : Term<TComponent> {
+	static constexpr bool kIsChecked = true;
+
+	static bool Match(const ComponentsPool<TComponent>* pool, Entity entity, ChangeTick since) {
+		return pool->HasChanged(entity, since);
+	}
+};
+
+template<typename TComponent>
+struct Term<Without<TComponent>> {
+	using Component = TComponent;
+	using Arguments = std::tuple<>;
+	using ConstArguments = std::tuple<>;
+
+	static constexpr bool kIsRequired = false;
+	static constexpr bool kIsChecked = true;
+
+	static bool Match(const ComponentsPool<Component>* pool, Entity entity, ChangeTick /*since*/) {
+		return pool == nullptr || !pool->Has(entity);
+	}
+
+	static Arguments GetArguments(ComponentsPool<Component>* /*pool*/, Entity /*entity*/) {
+		return {};
+	}
+};
+
+template<typename TComponent>
+struct Term<Optional<TComponent>> {
+	using Component = TComponent;
+	using Arguments = std::tuple<Component*>;
+	using ConstArguments = std::tuple<const Component*>;
+
+	static constexpr bool kIsRequired = false;
+	static constexpr bool kIsChecked = false;
+
+	static bool Match(const ComponentsPool<Component>* /*pool*/, Entity /*entity*/, ChangeTick /*since*/) {
+		return true;
+	}
+
+	static Arguments GetArguments(ComponentsPool<Component>* pool, Entity entity) {
+		return { pool != nullptr ? pool->Get(entity) : nullptr };
+	}
+};
+
+template<typename TTerm>
+using TermComponent = typename Term<TTerm>::Component;
+
+template<typename ...TTerms>
+constexpr bool kHasRequiredTerm = (Term<TTerms>::kIsRequired || ...);
+
+template<typename ...TTerms>
+constexpr bool kHasOnlyRequiredTerms = (Term<TTerms>::kIsRequired && ...);
+
+// Whether the function can be called with the entity and the arguments tuple.
+template<typename TFunction, typename TArguments>
+struct IsInvocableWithArguments;
+
+template<typename TFunction, typename ...TArguments>
+struct IsInvocableWithArguments<TFunction, std::tuple<TArguments...>>
+	: std::is_invocable<TFunction&, Entity, TArguments...>
+{};
+
+// Call operator templates are instantiated by the invocability check, so
+// their bodies can't be tried with const arguments.
+template<typename TFunction, typename = void>
+constexpr bool kHasCallOperatorTemplate = std::is_class_v<TFunction>;
+
+template<typename TFunction>
+constexpr bool kHasCallOperatorTemplate<TFunction, std::void_t<decltype(&TFunction::operator())>> = false;
+
+// Function writes the term component if it can't take it as const. Generic
+// functions are supposed to write all the components.
+template<typename TFunction, size_t TIndex, typename ...TTerms, size_t ...TIndices>
+constexpr bool IsTermWritten(std::index_sequence<TIndices...>) {
+	if constexpr (kHasCallOperatorTemplate<std::remove_cvref_t<TFunction>>) {
+		return true;
+	} else {
+		using Arguments = decltype(std::tuple_cat(std::declval<std::conditional_t<
+			TIndices == TIndex,
+			typename Term<TTerms>::ConstArguments,
+			typename Term<TTerms>::Arguments>>()...));
+
+		return !IsInvocableWithArguments<TFunction, Arguments>::value;
+	}
+}
+
+template<typename TFunction, typename ...TTerms, size_t ...TIndices>
+void MarkWrittenTerms(
+	const std::tuple<ComponentsPool<TermComponent<TTerms>>*...>& pools,
+	Entity entity,
+	std::index_sequence<TIndices...> indices)
+{
+	// Optional component may be absent.
+	auto mark = [entity](auto* pool, bool is_written, bool is_required) {
+		if (is_written && (is_required || pool != nullptr && pool->Has(entity))) {
+			pool->MarkChanged(entity);
+		}
+	};
+
+	(mark(std::get<TIndices>(pools), IsTermWritten<TFunction, TIndices, TTerms...>(indices), Term<TTerms>::kIsRequired), ...);
+}
+
+// Marks components which the function called for the entity takes as mutable.
+template<typename TFunction, typename ...TTerms>
+void MarkWrittenTerms(const std::tuple<ComponentsPool<TermComponent<TTerms>>*...>& pools, Entity entity) {
+	MarkWrittenTerms<TFunction, TTerms...>(pools, entity, std::index_sequence_for<TTerms...>());
+}
+
+} // namespace aoe
\ No newline at end of file
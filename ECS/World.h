@@ -1,60 +1,212 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 
 #include "../Core/Identifier.h"
+#include "../Core/ThreadPool.h"
 
 #include "ComponentsPool.h"
 #include "EntitiesPool.h"
 #include "ComponentHandler.h"
+#include "CommandBuffer.h"
+#include "Terms.h"
+#include "Query.h"
+#include "Group.h"
+#include "AccessChecker.h"
+#include "WorldSnapshot.h"
 
 namespace aoe {
 
+template<typename ...TAccesses>
+class WorldView;
+
+enum class WorldStorage {
+	kSparseSet,
+	kArchetype,
+};
+
 class World {
 private:
+	template<typename ...TAccesses>
+	friend class WorldView;
+	friend class WorldSerializer;
+
 	template<typename ...TComponents>
 	using ComponentsPools = std::tuple<ComponentsPool<TComponents>*...>;
-	using InnerIterator = EntitiesPool::Iterator;
+	using Entities = std::vector<Entity>;
 
 	class ECSIdentifier : public IdentifierBase<ECSIdentifier> {};
+	class QueryIdentifier : public IdentifierBase<QueryIdentifier> {};
+	class GroupIdentifier : public IdentifierBase<GroupIdentifier> {};
 
 public:
-	template<typename... TComponents>
+	// Terms are components or wrappers like Changed<TComponent>, see Terms.h.
+	template<typename... TTerms>
 	class Filter {
+	static_assert(kHasRequiredTerm<TTerms...>, "Filter requires at least one component.");
+
 	public:
 		class Iterator {
 		public:
 			using iterator_category = std::forward_iterator_tag;
 			using difference_type = std::ptrdiff_t;
 			using value_type = Entity;
-			using pointer = value_type*;
-			using reference = value_type&;
+			using pointer = const value_type*;
+			using reference = const value_type&;
 
-			Iterator(World* world, InnerIterator it, InnerIterator end)
-				: pools_(world->GetPools<TComponents...>())
-				, it_(it)
-				, end_(end)
+			Iterator(
+				World* world,
+				const Entities* entities,
+				size_t index,
+				ArchetypeStorage::Cursor cursor,
+				ChangeTick since)
+				: pools_(world->GetPools<TermComponent<TTerms>...>())
+				, entities_(entities)
+				, index_(index)
+				, cursor_(cursor)
+				, since_(since)
 			{
-				if (it_ == end_) {
-					return;
+				if (IsSkipped()) {
+					Advance();
 				}
+			}
 
-				if (World::HasNullPools(pools_)) {
-					it_ = end_;
-					return;
+			reference operator*() const {
+				if (entities_ == nullptr) {
+					return cursor_.GetEntity();
 				}
 
-				if (!World::HasRequiredComponents(pools_, *it_)) {
-					Advance();
+				return (*entities_)[index_ - 1];
+			}
+
+			pointer operator->() const {
+				return &operator*();
+			}
+
+			Iterator& operator++() {
+				Advance();
+				return *this;
+			}
+
+			Iterator operator++(int) {
+				Iterator temp = *this;
+				Advance();
+				return temp;
+			}
+
+			friend bool operator== (const Iterator& lhs, const Iterator& rhs) {
+				return lhs.index_ == rhs.index_ && lhs.cursor_ == rhs.cursor_;
+			};
+
+			friend bool operator!= (const Iterator& lhs, const Iterator& rhs) {
+				return !(lhs == rhs);
+			};
+
+		private:
+			ComponentsPools<TermComponent<TTerms>...> pools_;
+			const Entities* entities_;
+			size_t index_;
+			ArchetypeStorage::Cursor cursor_;
+			ChangeTick since_;
+
+			bool IsEnd() const {
+				return entities_ == nullptr ? cursor_ == ArchetypeStorage::Cursor() : index_ == 0;
+			}
+
+			// Archetypes contain all the components, so only the terms are checked.
+			bool IsSkipped() const {
+				if (IsEnd()) {
+					return false;
 				}
+
+				if (entities_ == nullptr) {
+					return !World::MatchTerms<TTerms...>(pools_, operator*(), since_);
+				}
+
+				return !World::IsMatched<TTerms...>(pools_, operator*(), since_);
 			}
 
-			reference operator*() {
-				return *it_;
+			// Dense arrays are walked backward, so removing the current entity
+			// only swaps in an already visited one.
+			void Advance() {
+				do {
+					if (entities_ == nullptr) {
+						cursor_.Advance();
+					} else {
+						index_ -= 1;
+					}
+				} while (IsSkipped());
 			}
+		};
+
+		Filter(World* world, ChangeTick since)
+			: world_(world)
+			, entities_(nullptr)
+			, archetypes_()
+			, since_(since)
+		{
+			if (world_->storage_ == WorldStorage::kArchetype) {
+				archetypes_ = world_->GetArchetypes<TTerms...>();
+			} else {
+				entities_ = GetSmallestPoolEntities<TTerms...>(world_->GetPools<TermComponent<TTerms>...>());
+			}
+		}
+
+		Iterator begin() {
+			size_t size = entities_ != nullptr ? entities_->size() : 0;
+			return { world_, entities_, size, ArchetypeStorage::Cursor(&archetypes_), since_ };
+		}
+
+		Iterator end() {
+			return { world_, entities_, 0, ArchetypeStorage::Cursor(), since_ };
+		}
+
+	private:
+		World* world_;
+		const Entities* entities_;
+		ArchetypeStorage::Archetypes archetypes_;
+		ChangeTick since_;
+	};
+
+	template<typename TComponent>
+	class View {
+	private:
+		using PoolIterator = typename ComponentsPool<TComponent>::Iterator;
 
-			pointer operator->() {
-				return &(*it_);
+	public:
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = std::pair<Entity, TComponent&>;
+			using reference = value_type;
+
+			Iterator(
+				ComponentsPool<TComponent>* pool,
+				PoolIterator it,
+				ArchetypeStorage::Cursor cursor,
+				bool is_archetype)
+				: pool_(pool)
+				, it_(it)
+				, cursor_(cursor)
+				, is_archetype_(is_archetype)
+			{}
+
+			// Components are accessed mutably, so they are marked as changed.
+			reference operator*() const {
+				if (!is_archetype_) {
+					reference pair = *it_;
+					pool_->MarkChanged(pair.first);
+					return pair;
+				}
+
+				Archetype* archetype = cursor_.GetArchetype();
+				size_t column = archetype->FindColumn(ArchetypeStorage::GetTypeId<TComponent>());
+				pool_->MarkChanged(cursor_.GetEntity());
+				return { cursor_.GetEntity(), *archetype->Get<TComponent>(column, cursor_.GetRow()) };
 			}
 
 			Iterator& operator++() {
@@ -69,62 +221,89 @@ public:
 			}
 
 			friend bool operator== (const Iterator& lhs, const Iterator& rhs) {
-				return lhs.it_ == rhs.it_;
+				return lhs.it_ == rhs.it_ && lhs.cursor_ == rhs.cursor_;
 			};
 
 			friend bool operator!= (const Iterator& lhs, const Iterator& rhs) {
-				return lhs.it_ != rhs.it_;
+				return !(lhs == rhs);
 			};
 
 		private:
-			ComponentsPools<TComponents...> pools_;
-			InnerIterator it_;
-			InnerIterator end_;
+			ComponentsPool<TComponent>* pool_;
+			PoolIterator it_;
+			ArchetypeStorage::Cursor cursor_;
+			bool is_archetype_;
 
 			void Advance() {
-				for (std::advance(it_, 1); it_ != end_; std::advance(it_, 1)) {
-					if (World::HasRequiredComponents(pools_, *it_)) {
-						return;
-					}
+				if (is_archetype_) {
+					cursor_.Advance();
+				} else {
+					++it_;
 				}
 			}
 		};
 
-		Filter(World* world)
-			: world_(world)
-		{}
+		View(World* world)
+			: pool_(world->GetPool<TComponent>())
+			, archetypes_()
+			, is_archetype_(world->storage_ == WorldStorage::kArchetype)
+		{
+			if (is_archetype_) {
+				archetypes_ = world->archetypes_.GetArchetypes<TComponent>();
+			}
+		}
 
 		Iterator begin() {
-			auto it = world_->entities_pool_.begin();
-			auto end = world_->entities_pool_.end();
-			return { world_, it, end };
+			PoolIterator it = pool_ != nullptr && !is_archetype_ ? pool_->begin() : PoolIterator();
+			return { pool_, it, ArchetypeStorage::Cursor(&archetypes_), is_archetype_ };
 		}
 
 		Iterator end() {
-			auto it = world_->entities_pool_.end();
-			auto end = world_->entities_pool_.end();
-			return { world_, it, end };
+			PoolIterator it = pool_ != nullptr && !is_archetype_ ? pool_->end() : PoolIterator();
+			return { pool_, it, ArchetypeStorage::Cursor(), is_archetype_ };
 		}
 
 	private:
-		World* world_;
+		ComponentsPool<TComponent>* pool_;
+		ArchetypeStorage::Archetypes archetypes_;
+		bool is_archetype_;
 	};
 
+	static constexpr size_t kParallelBatchSize = 1024;
+
 	Event<World, Entity> EntityCreated;
 	Event<World, Entity> EntityDestroyed;
+	// Notifies after entities and components are replaced in bulk.
+	Event<World> Restored;
 
-	World()
+	World(WorldStorage storage = WorldStorage::kSparseSet)
 		: component_pools_()
 		, entities_pool_()
+		, archetypes_()
+		, storage_(storage)
 		, to_destroy_()
+		, commands_()
+		, attached_commands_()
+		, change_tick_(1)
+		, queries_()
+		, groups_()
+		, access_checker_()
 	{}
 
 	~World() {
+		// Queries and groups detach from the pools events.
+		queries_.clear();
+		groups_.clear();
+
 		for (IComponentsPool* pool: component_pools_) {
 			delete pool;
 		}
 	}
 
+	WorldStorage GetStorage() const {
+		return storage_;
+	}
+
 	template<typename TComponent>
 	EventBase<Entity>& ComponentAdded() {
 		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
@@ -137,15 +316,122 @@ public:
 		return pool->ComponentRemoved;
 	}
 
+	template<typename TComponent>
+	EventBase<std::span<const Entity>>& ComponentsAdded() {
+		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
+		return pool->ComponentsAdded;
+	}
+
+	template<typename TComponent>
+	EventBase<std::span<const Entity>>& ComponentsRemoved() {
+		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
+		return pool->ComponentsRemoved;
+	}
+
+	ChangeTick GetChangeTick() const {
+		return change_tick_.load(std::memory_order_relaxed);
+	}
+
+	// Components accessed mutably after the increment are marked with the new tick.
+	ChangeTick IncrementChangeTick() {
+		return change_tick_.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	// Tick of the last mutable access to any component of the type.
+	template<typename TComponent>
+	ChangeTick GetLastChangeTick() const {
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+		return pool != nullptr ? pool->GetLastChangeTick() : 0;
+	}
+
 	bool IsEntityValid(Entity entity) const {
 		return entities_pool_.IsValid(entity);
 	}
 
 	Entity CreateEntity() {
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't create entity in parallel section.");
 		return entities_pool_.Create();
 	}
 
+	// Reserves storage for the entities count, so creation doesn't reallocate.
+	void Reserve(size_t count) {
+		entities_pool_.Reserve(count);
+	}
+
+	template<typename TComponent>
+	void ReserveComponents(size_t count) {
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't reserve in parallel section.");
+		GetOrCreatePool<TComponent>()->Reserve(count);
+	}
+
+	Entities CreateEntities(size_t count) {
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't create entity in parallel section.");
+		entities_pool_.Reserve(entities_pool_.GetSize() + count);
+
+		Entities entities;
+		entities.reserve(count);
+
+		for (size_t index = 0; index < count; ++index) {
+			entities.push_back(entities_pool_.Create());
+		}
+
+		return entities;
+	}
+
+	// Moves the entities with their components to the destination world pool
+	// by pool and destroys them. Returns the destination entities in the same
+	// order. Both worlds send the batched components events. Entities mustn't
+	// be duplicated.
+	Entities MoveEntities(std::span<const Entity> entities, World& destination) {
+		AOE_ASSERT_MSG(&destination != this, "Can't move entities to the same world.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't move entities in parallel section.");
+		AOE_ASSERT_MSG(destination.GetDeferredCommands() == nullptr, "Can't move entities in parallel section.");
+
+		for (Entity entity : entities) {
+			AssertEntityIsValid(entity);
+		}
+
+#ifndef NDEBUG
+		Entities sorted(entities.begin(), entities.end());
+		std::sort(sorted.begin(), sorted.end(), [](Entity lhs, Entity rhs) {
+			return lhs.GetId() < rhs.GetId();
+		});
+		AOE_ASSERT_MSG(
+			std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end(),
+			"Can't move duplicated entities.");
+#endif // !NDEBUG
+
+		Entities moved = destination.CreateEntities(entities.size());
+
+		for (size_t type_id = 0; type_id < component_pools_.size(); ++type_id) {
+			IComponentsPool* pool = component_pools_[type_id];
+
+			// Destination pools are created only for the moved components.
+			bool has_moved = pool != nullptr && std::any_of(entities.begin(), entities.end(), [pool](Entity entity) {
+				return pool->Has(entity);
+			});
+
+			if (has_moved) {
+				pool->MoveRange(entities, *destination.GetOrCreatePool(type_id, *pool), moved);
+			}
+		}
+
+		for (Entity entity : entities) {
+			EntityDestroyed.Notify(entity);
+			entities_pool_.Destroy(entity);
+		}
+
+		return moved;
+	}
+
 	void DestroyEntity(Entity entity) {
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			commands->DestroyEntity(entity);
+			return;
+		}
+
 		if (IsEntityValid(entity)) {
 			to_destroy_.push_back(entity);
 		}
@@ -160,83 +446,609 @@ public:
 			return false;
 		}
 
-		return pool->Has(entity.GetId());
+		return pool->Has(entity);
 	}
 
 	template<typename TComponent, typename ...TArgs>
 	void AddComponent(Entity entity, TArgs&&... args) {
 		AssertEntityIsValid(entity);
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			commands->AddComponent<TComponent>(entity, std::forward<TArgs>(args)...);
+			return;
+		}
+
 		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
 		pool->Emplace(entity, std::forward<TArgs>(args)...);
 	}
 
+	// Adds components constructed from the same arguments to all entities
+	// and notifies about them with a single batched event.
+	template<typename TComponent, typename ...TArgs>
+	void AddComponents(std::span<const Entity> entities, const TArgs&... args) {
+		for (Entity entity : entities) {
+			AssertEntityIsValid(entity);
+		}
+
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			for (Entity entity : entities) {
+				commands->AddComponent<TComponent>(entity, args...);
+			}
+
+			return;
+		}
+
+		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
+		pool->EmplaceRange(entities, args...);
+	}
+
+	// Adds components moved from the array, components are paired with the
+	// entities by index and notified with a single batched event.
+	template<typename TComponent>
+	void AddComponents(std::span<const Entity> entities, std::span<TComponent> components) {
+		AOE_ASSERT_MSG(entities.size() == components.size(), "Invalid components count.");
+
+		for (Entity entity : entities) {
+			AssertEntityIsValid(entity);
+		}
+
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			for (size_t index = 0; index < entities.size(); ++index) {
+				commands->AddComponent<TComponent>(entities[index], std::move(components[index]));
+			}
+
+			return;
+		}
+
+		ComponentsPool<TComponent>* pool = GetOrCreatePool<TComponent>();
+		pool->AddRange(entities, components);
+	}
+
 	template<typename TComponent>
 	CH<TComponent> GetComponent(Entity entity) {
 		AssertEntityIsValid(entity);
 		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
-		return { pool, entity.GetId() };
+		return { pool, entity };
 	}
 
 	template<typename TComponent>
 	void RemoveComponent(Entity entity) {
 		AssertEntityIsValid(entity);
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			commands->RemoveComponent<TComponent>(entity);
+			return;
+		}
+
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+
+		if (pool != nullptr) {
+			pool->Remove(entity);
+		}
+	}
+
+	template<typename TComponent>
+	void RemoveComponents(std::span<const Entity> entities) {
+		for (Entity entity : entities) {
+			AssertEntityIsValid(entity);
+		}
+
+		CommandBuffer* commands = GetDeferredCommands();
+
+		if (commands != nullptr) {
+			for (Entity entity : entities) {
+				commands->RemoveComponent<TComponent>(entity);
+			}
+
+			return;
+		}
+
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+
+		if (pool != nullptr) {
+			pool->RemoveRange(entities);
+		}
+	}
+
+	// Reorders the pool dense storage, so iteration visits components in
+	// the compare order. Incremental, sorting every frame is cheap.
+	template<typename TComponent, typename TCompare>
+	void Sort(TCompare compare) {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support sorting.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't sort in parallel section.");
+
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+
+		if (pool != nullptr) {
+			pool->Sort(compare);
+		}
+	}
+
+	// Reorders the pool to follow the order of the other one.
+	template<typename TComponent, typename TOther>
+	void SortAs() {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support sorting.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't sort in parallel section.");
+
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+		ComponentsPool<TOther>* other = GetPool<TOther>();
+
+		if (pool != nullptr && other != nullptr) {
+			pool->SortAs(*other);
+		}
+	}
+
+	// Reorders the pool dense storage, so the entities go first in the given
+	// order and the components are read linearly with them, see GetDenseComponents.
+	template<typename TComponent>
+	void Arrange(std::span<const Entity> entities) {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support sorting.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't sort in parallel section.");
+
 		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
 
 		if (pool != nullptr) {
-			pool->Remove(entity.GetId());
+			pool->Arrange(entities);
+		}
+	}
+
+	template<typename TComponent>
+	std::span<const Entity> GetDenseEntities() const {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage isn't dense.");
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+
+		if (pool == nullptr) {
+			return {};
+		}
+
+		return pool->GetEntities();
+	}
+
+	// Components in the order of GetDenseEntities. Mutable access doesn't
+	// mark them as changed, see MarkChanged.
+	template<typename TComponent>
+	std::span<TComponent> GetDenseComponents() {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage isn't dense.");
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+
+		if (pool == nullptr) {
+			return {};
+		}
+
+		return pool->GetComponents();
+	}
+
+	template<typename TComponent>
+	void MarkChanged(Entity entity) {
+		AssertEntityIsValid(entity);
+		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
+		AOE_ASSERT_MSG(pool != nullptr && pool->Has(entity), "Entity doesn't have a required component.");
+		pool->MarkChanged(entity);
+	}
+
+	// Buffer for the structural changes which are applied at the validation.
+	CommandBuffer& GetCommandBuffer() {
+		return commands_;
+	}
+
+	// Attached buffers are flushed at the validation in the attachment order,
+	// before the world buffer.
+	void AttachCommandBuffer(CommandBuffer* commands) {
+		attached_commands_.push_back(commands);
+	}
+
+	void DetachCommandBuffer(CommandBuffer* commands) {
+		auto it = std::find(attached_commands_.begin(), attached_commands_.end(), commands);
+
+		if (it != attached_commands_.end()) {
+			attached_commands_.erase(it);
 		}
 	}
 
 	void Validate() {
-		for (Entity entity : to_destroy_) {
+		for (CommandBuffer* commands : attached_commands_) {
+			Flush(*commands);
+		}
+
+		Flush(commands_);
+
+		// Handlers of the removal events may destroy more entities.
+		for (size_t index = 0; index < to_destroy_.size(); ++index) {
+			Entity entity = to_destroy_[index];
+
 			if (!IsEntityValid(entity)) {
 				continue;
 			}
 
 			for (IComponentsPool* pool : component_pools_) {
-				pool->Remove(entity.GetId());
+				if (pool != nullptr) {
+					pool->Remove(entity);
+				}
 			}
 
 			EntityDestroyed.Notify(entity);
 			entities_pool_.Destroy(entity);
 		}
+
+		to_destroy_.clear();
 	}
 
-	template <typename ...TComponents, typename TFunction>
-	void ForEach(TFunction function) {
-		ComponentsPools<TComponents...> pools = GetPools<TComponents...>();
+	// Copies entities and components, components must be copyable. Pending
+	// structural changes aren't captured.
+	WorldSnapshot Snapshot() const {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support snapshots.");
 
-		if (HasNullPools(pools)) {
-			return;
+		WorldSnapshot::ComponentsSnapshots components;
+		components.reserve(component_pools_.size());
+
+		for (IComponentsPool* pool : component_pools_) {
+			components.push_back(pool != nullptr ? pool->Snapshot() : nullptr);
 		}
 
-		for (Entity entity : entities_pool_) {
-			if (!HasRequiredComponents(pools, entity)) {
-				continue;
+		return WorldSnapshot(entities_pool_.Snapshot(), std::move(components));
+	}
+
+	// Replaces entities and components with the snapshot ones in bulk. Only
+	// the Restored event is sent, queries and groups are rebuilt, restored
+	// components are marked as changed. Pending structural changes of the
+	// world are dropped.
+	void Restore(const WorldSnapshot& snapshot) {
+		AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support snapshots.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't restore in parallel section.");
+
+		entities_pool_.Restore(snapshot.entities_);
+
+		for (size_t type_id = 0; type_id < snapshot.components_.size(); ++type_id) {
+			AOE_ASSERT_MSG(
+				snapshot.components_[type_id] == nullptr || (type_id < component_pools_.size() && component_pools_[type_id] != nullptr),
+				"World doesn't have the snapshot components pool.");
+		}
+
+		for (size_t type_id = 0; type_id < component_pools_.size(); ++type_id) {
+			if (component_pools_[type_id] != nullptr) {
+				const IComponentsSnapshot* components = type_id < snapshot.components_.size()
+					? snapshot.components_[type_id].get()
+					: nullptr;
+
+				component_pools_[type_id]->Restore(components);
+			}
+		}
+
+		OnRestored();
+	}
+
+	// Entities are matched against terms changed after the since tick.
+	// Components taken by the function as non-const references are marked
+	// as changed, so read only functions should take const references.
+	template <typename ...TTerms, typename TFunction>
+	void ForEach(TFunction function, ChangeTick since = 0) {
+		static_assert(kHasRequiredTerm<TTerms...>, "ForEach requires at least one component.");
+		ComponentsPools<TermComponent<TTerms>...> pools = GetPools<TermComponent<TTerms>...>();
+
+		if (storage_ == WorldStorage::kSparseSet) {
+			const Entities* entities = GetSmallestPoolEntities<TTerms...>(pools);
+
+			if (entities == nullptr) {
+				return;
+			}
+
+			for (size_t index = entities->size(); index > 0; --index) {
+				Entity entity = (*entities)[index - 1];
+
+				if (IsMatched<TTerms...>(pools, entity, since)) {
+					Invoke<TTerms...>(function, pools, entity);
+				}
+			}
+		} else if constexpr (kHasOnlyRequiredTerms<TTerms...>) {
+			auto visit = [&](Entity entity, TermComponent<TTerms>&... components) {
+				if (MatchTerms<TTerms...>(pools, entity, since)) {
+					function(entity, components...);
+					MarkWrittenTerms<TFunction, TTerms...>(pools, entity);
+				}
+			};
+
+			archetypes_.ForEach<TermComponent<TTerms>...>(visit);
+		} else {
+			for (Entity entity : Filter<TTerms...>(this, since)) {
+				Invoke<TTerms...>(function, pools, entity);
+			}
+		}
+	}
+
+	// Splits matched entities into batches and processes them on the pool.
+	// Structural changes made by the function are recorded per batch and
+	// applied in the batches order after all of them are processed.
+	template <typename ...TTerms, typename TFunction>
+	void ParallelForEach(
+		ThreadPool& pool,
+		TFunction function,
+		ChangeTick since = 0,
+		size_t batch_size = kParallelBatchSize)
+	{
+		static_assert(kHasRequiredTerm<TTerms...>, "ParallelForEach requires at least one component.");
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Nested parallel sections are not supported.");
+		ComponentsPools<TermComponent<TTerms>...> pools = GetPools<TermComponent<TTerms>...>();
+		std::vector<CommandBuffer> commands;
+
+		if (storage_ == WorldStorage::kArchetype) {
+			ArchetypeStorage::Chunks chunks = ArchetypeStorage::GetChunks(GetArchetypes<TTerms...>());
+			commands.resize(chunks.size());
+
+			pool.ParallelFor(chunks.size(), 1, [&](size_t begin, size_t /*end*/) {
+				DeferCommands(&commands[begin]);
+				ForEach<TTerms...>(chunks[begin], function, pools, since);
+				DeferCommands(nullptr);
+			});
+		} else {
+			const Entities* entities = GetSmallestPoolEntities<TTerms...>(pools);
+
+			if (entities == nullptr) {
+				return;
+			}
+
+			commands.resize((entities->size() + batch_size - 1) / batch_size);
+
+			pool.ParallelFor(entities->size(), batch_size, [&](size_t begin, size_t end) {
+				DeferCommands(&commands[begin / batch_size]);
+
+				for (size_t index = end; index > begin; --index) {
+					Entity entity = (*entities)[index - 1];
+
+					if (IsMatched<TTerms...>(pools, entity, since)) {
+						Invoke<TTerms...>(function, pools, entity);
+					}
+				}
+
+				DeferCommands(nullptr);
+			});
+		}
+
+		for (CommandBuffer& batch_commands : commands) {
+			Flush(batch_commands);
+		}
+	}
+
+	// Creates recorded entities, applies component commands type by type
+	// and destroys recorded entities at the next validation.
+	void Flush(CommandBuffer& commands) {
+		AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't flush commands in parallel section.");
+		CommandBuffer::Entities created;
+
+		for (size_t count = 0; count < commands.created_count_; ++count) {
+			created.push_back(CreateEntity());
+		}
+
+		for (CommandBuffer::Queue& queue : commands.queues_) {
+			if (queue.commands != nullptr && !queue.commands->IsEmpty()) {
+				queue.apply(*queue.commands, *this, created);
 			}
+		}
 
-			function(entity, CH<TComponents>(std::get<ComponentsPool<TComponents>*>(pools), entity)...);
+		for (Entity entity : commands.destroyed_entities_) {
+			DestroyEntity(CommandBuffer::Resolve(entity, created));
 		}
+
+		commands.created_count_ = 0;
+		commands.destroyed_entities_.clear();
 	}
 
-	template <typename ...TComponents>
-	Filter<TComponents...> FilterEntities() {
-		return Filter<TComponents...>(this);
+	template <typename ...TTerms>
+	Filter<TTerms...> FilterEntities(ChangeTick since = 0) {
+		return Filter<TTerms...>(this, since);
+	}
+
+	// Query is created at the first request and then maintained by the world.
+	template<typename ...TComponents>
+	Query<TComponents...>& GetQuery() {
+		TypeId type_id = QueryIdentifier::GetTypeId<Query<TComponents...>>();
+
+		if (queries_.size() <= type_id) {
+			queries_.resize(type_id + 1);
+		}
+
+		if (queries_[type_id] == nullptr) {
+			AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't create query in parallel section.");
+			auto query = std::make_unique<Query<TComponents...>>(GetOrCreatePool<TComponents>()...);
+
+			for (Entity entity : FilterEntities<TComponents...>()) {
+				query->Add(entity);
+			}
+
+			queries_[type_id] = std::move(query);
+		}
+
+		return static_cast<Query<TComponents...>&>(*queries_[type_id]);
+	}
+
+	// Group is created at the first request and takes ownership of the pools.
+	template<typename ...TComponents>
+	Group<TComponents...>& GetGroup() {
+		TypeId type_id = GroupIdentifier::GetTypeId<Group<TComponents...>>();
+
+		if (groups_.size() <= type_id) {
+			groups_.resize(type_id + 1);
+		}
+
+		if (groups_[type_id] == nullptr) {
+			AOE_ASSERT_MSG(storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support groups.");
+			AOE_ASSERT_MSG(GetDeferredCommands() == nullptr, "Can't create group in parallel section.");
+
+			auto group = std::make_unique<Group<TComponents...>>(GetOrCreatePool<TComponents>()...);
+			ComponentsPools<TComponents...> pools = GetPools<TComponents...>();
+
+			// Group reorders the pools, so the entities are copied.
+			Entities entities = *GetSmallestPoolEntities<TComponents...>(pools);
+
+			for (Entity entity : entities) {
+				if (IsMatched<TComponents...>(pools, entity, 0)) {
+					group->Add(entity);
+				}
+			}
+
+			groups_[type_id] = std::move(group);
+		}
+
+		return static_cast<Group<TComponents...>&>(*groups_[type_id]);
+	}
+
+	template<typename TComponent>
+	View<TComponent> ViewComponents() {
+		return View<TComponent>(this);
 	}
 
 private:
+	struct DeferredCommands {
+		const World* world;
+		CommandBuffer* commands;
+	};
+
+	inline static thread_local DeferredCommands deferred_commands_ = { nullptr, nullptr };
+
 	std::vector<IComponentsPool*> component_pools_;
 	EntitiesPool entities_pool_;
+	ArchetypeStorage archetypes_;
+	WorldStorage storage_;
 	std::vector<Entity> to_destroy_;
+	CommandBuffer commands_;
+	std::vector<CommandBuffer*> attached_commands_;
+	std::atomic<ChangeTick> change_tick_;
+	std::vector<std::unique_ptr<IQuery>> queries_;
+	std::vector<std::unique_ptr<IGroup>> groups_;
+	AccessChecker access_checker_;
 
-	template<typename ...TComponents>
-	static bool HasNullPools(ComponentsPools<TComponents...>& pools) {
-		return ((std::get<ComponentsPool<TComponents>*>(pools) == nullptr) || ...);
+	// Rebuilds queries and groups after the bulk replacement of the pools.
+	void OnRestored() {
+		for (const std::unique_ptr<IQuery>& query : queries_) {
+			if (query != nullptr) {
+				query->Reset();
+			}
+		}
+
+		for (const std::unique_ptr<IGroup>& group : groups_) {
+			if (group != nullptr) {
+				group->Reset();
+			}
+		}
+
+		to_destroy_.clear();
+		commands_.Clear();
+		Restored.Notify();
 	}
 
-	template<typename ...TComponents>
-	static bool HasRequiredComponents(ComponentsPools<TComponents...>& pools, Entity entity) {
-		return (std::get<ComponentsPool<TComponents>*>(pools)->Has(entity) && ...);
+	template<typename ...TTerms>
+	static bool HasNullPools(const ComponentsPools<TermComponent<TTerms>...>& pools) {
+		return ((Term<TTerms>::kIsRequired && std::get<ComponentsPool<TermComponent<TTerms>>*>(pools) == nullptr) || ...);
+	}
+
+	// Entities of the smallest required components pool.
+	template<typename ...TTerms>
+	static const Entities* GetSmallestPoolEntities(const ComponentsPools<TermComponent<TTerms>...>& pools) {
+		if (HasNullPools<TTerms...>(pools)) {
+			return nullptr;
+		}
+
+		const Entities* smallest = nullptr;
+
+		auto select = [&smallest](const auto* pool, bool is_required) {
+			if (is_required && (smallest == nullptr || pool->GetSize() < smallest->size())) {
+				smallest = &pool->GetEntities();
+			}
+		};
+
+		(select(std::get<ComponentsPool<TermComponent<TTerms>>*>(pools), Term<TTerms>::kIsRequired), ...);
+		return smallest;
+	}
+
+	template<typename ...TTerms>
+	static bool MatchTerms(
+		const ComponentsPools<TermComponent<TTerms>...>& pools,
+		Entity entity,
+		ChangeTick since)
+	{
+		return (Term<TTerms>::Match(std::get<ComponentsPool<TermComponent<TTerms>>*>(pools), entity, since) && ...);
+	}
+
+	template<typename ...TTerms>
+	static bool IsMatched(
+		const ComponentsPools<TermComponent<TTerms>...>& pools,
+		Entity entity,
+		ChangeTick since)
+	{
+		return ((!Term<TTerms>::kIsRequired || std::get<ComponentsPool<TermComponent<TTerms>>*>(pools)->Has(entity)) && ...)
+			&& MatchTerms<TTerms...>(pools, entity, since);
+	}
+
+	// Archetypes with the required components and without the excluded ones.
+	template<typename ...TTerms>
+	ArchetypeStorage::Archetypes GetArchetypes() const {
+		Archetype::Signature required;
+		Archetype::Signature excluded;
+
+		auto add = [&](TypeId type_id, bool is_required, bool is_excluded) {
+			if (is_required) {
+				required.push_back(type_id);
+			} else if (is_excluded) {
+				excluded.push_back(type_id);
+			}
+		};
+
+		(add(
+			ArchetypeStorage::GetTypeId<TermComponent<TTerms>>(),
+			Term<TTerms>::kIsRequired,
+			std::is_same_v<TTerms, Without<TermComponent<TTerms>>>), ...);
+
+		return archetypes_.GetArchetypes(required, excluded);
+	}
+
+	// Archetype chunk contains all the required components.
+	template<typename ...TTerms, typename TFunction>
+	static void ForEach(
+		const ArchetypeStorage::Chunk& chunk,
+		TFunction& function,
+		const ComponentsPools<TermComponent<TTerms>...>& pools,
+		ChangeTick since)
+	{
+		if constexpr (kHasOnlyRequiredTerms<TTerms...>) {
+			auto visit = [&](Entity entity, TermComponent<TTerms>&... components) {
+				if (MatchTerms<TTerms...>(pools, entity, since)) {
+					function(entity, components...);
+					MarkWrittenTerms<TFunction, TTerms...>(pools, entity);
+				}
+			};
+
+			ArchetypeStorage::ForEach<TermComponent<TTerms>...>(chunk, visit);
+		} else {
+			const Entity* entities = chunk.archetype->GetEntities(chunk.index);
+
+			for (size_t row = chunk.archetype->GetChunkSize(chunk.index); row > 0; --row) {
+				if (MatchTerms<TTerms...>(pools, entities[row - 1], since)) {
+					Invoke<TTerms...>(function, pools, entities[row - 1]);
+				}
+			}
+		}
+	}
+
+	template<typename ...TTerms, typename TFunction>
+	static void Invoke(TFunction& function, const ComponentsPools<TermComponent<TTerms>...>& pools, Entity entity) {
+		std::apply(function, std::tuple_cat(
+			std::tuple<Entity>(entity),
+			Term<TTerms>::GetArguments(std::get<ComponentsPool<TermComponent<TTerms>>*>(pools), entity)...));
+
+		MarkWrittenTerms<TFunction, TTerms...>(pools, entity);
+	}
+
+	CommandBuffer* GetDeferredCommands() const {
+		return deferred_commands_.world == this ? deferred_commands_.commands : nullptr;
+	}
+
+	void DeferCommands(CommandBuffer* commands) {
+		deferred_commands_ = { this, commands };
 	}
 
 	void AssertEntityIsValid(Entity entity) const {
@@ -268,11 +1080,26 @@ private:
 			component_pools_.resize(type_id + 1, nullptr);
 		}
 
-		ComponentsPool<TComponent>* pool = new ComponentsPool<TComponent>();
+		ArchetypeStorage* archetypes = storage_ == WorldStorage::kArchetype ? &archetypes_ : nullptr;
+		ComponentsPool<TComponent>* pool = new ComponentsPool<TComponent>(archetypes, &change_tick_);
 		component_pools_[type_id] = pool;
 		return pool;
 	}
 
+	// Pool of the prototype components which may come from another world.
+	IComponentsPool* GetOrCreatePool(TypeId type_id, const IComponentsPool& prototype) {
+		if (component_pools_.size() <= type_id) {
+			component_pools_.resize(type_id + 1, nullptr);
+		}
+
+		if (component_pools_[type_id] == nullptr) {
+			ArchetypeStorage* archetypes = storage_ == WorldStorage::kArchetype ? &archetypes_ : nullptr;
+			component_pools_[type_id] = prototype.CreateEmpty(archetypes, &change_tick_);
+		}
+
+		return component_pools_[type_id];
+	}
+
 	template<typename TComponent>
 	ComponentsPool<TComponent>* GetOrCreatePool() {
 		ComponentsPool<TComponent>* pool = GetPool<TComponent>();
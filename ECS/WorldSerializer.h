@@ -0,0 +1,497 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Core/Debug.h"
+#include "../Core/MappedFile.h"
+#include "../Reflection/Reflector.h"
+#include "../Reflection/TypeName.h"
+
+#include "World.h"
+
+namespace aoe {
+
+// Saves and loads the world entities and the registered components. File
+// starts with the header and the blocks table followed by the entities and
+// the per pool blocks at aligned offsets, so the mapped file is read in place.
+// Trivially copyable components are stored as is and copied in bulk, other
+// ones are written field by field with their reflection types.
+//
+// Pools aren't backed by the mapped file, since they own growable storage:
+// loaded blocks are copied into the pools with a single bulk copy per block
+// and the file is unmapped afterwards. Blocks keep the dense entities instead
+// of the sparse index, which is rebuilt on load, so the file doesn't depend
+// on the sparse pages layout and stays proportional to the components count.
+class WorldSerializer {
+public:
+	WorldSerializer()
+		: codecs_()
+	{}
+
+	// Components which aren't trivially copyable must be reflected and
+	// default constructible, fields are expanded up to trivially copyable ones.
+	// Expanded types mustn't have base classes.
+	template<typename TComponent>
+	void Register() {
+		static_assert(
+			std::is_trivially_copyable_v<TComponent> || std::is_default_constructible_v<TComponent>,
+			"Reflected component must be default constructible.");
+
+		if constexpr (!std::is_trivially_copyable_v<TComponent>) {
+			AssertSerializable(Reflector::GetType<TComponent>());
+		}
+
+		codecs_.push_back({ std::string(TypeName<TComponent>()), &SaveComponents<TComponent>, &DecodeComponents<TComponent> });
+	}
+
+	bool Save(const World& world, const std::filesystem::path& path) const {
+		AOE_ASSERT_MSG(world.storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support serialization.");
+
+		EntitiesSnapshot entities = world.entities_pool_.Snapshot();
+		std::vector<Block> blocks(codecs_.size());
+
+		for (size_t index = 0; index < codecs_.size(); ++index) {
+			codecs_[index].save(world, blocks[index]);
+		}
+
+		FileHeader header{};
+		header.magic = kMagic;
+		header.version = kVersion;
+		header.blocks_count = blocks.size();
+		header.entities_count = entities.entities.size();
+		header.bound = entities.bound;
+		header.retired_count = entities.retired_count;
+
+		uint64_t offset = sizeof(FileHeader) + sizeof(BlockHeader) * blocks.size();
+		header.entities_offset = Align(offset);
+		offset = header.entities_offset + sizeof(Entity) * entities.entities.size();
+
+		std::vector<BlockHeader> block_headers(blocks.size());
+
+		for (size_t index = 0; index < blocks.size(); ++index) {
+			const std::string& name = codecs_[index].name;
+			AOE_ASSERT_MSG(name.size() < kNameSize, "Component name is too long.");
+
+			BlockHeader& block_header = block_headers[index];
+			std::memcpy(block_header.name, name.data(), name.size());
+			block_header.is_trivial = blocks[index].is_trivial;
+			block_header.element_size = blocks[index].element_size;
+			block_header.count = blocks[index].entities.size();
+			block_header.entities_offset = Align(offset);
+			block_header.payload_offset = Align(block_header.entities_offset + blocks[index].entities.size_bytes());
+			block_header.payload_size = blocks[index].payload.size();
+			offset = block_header.payload_offset + block_header.payload_size;
+		}
+
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		Write(stream, &header, sizeof(header));
+		Write(stream, block_headers.data(), sizeof(BlockHeader) * block_headers.size());
+		Pad(stream, header.entities_offset);
+		Write(stream, entities.entities.data(), sizeof(Entity) * entities.entities.size());
+
+		for (size_t index = 0; index < blocks.size(); ++index) {
+			Pad(stream, block_headers[index].entities_offset);
+			Write(stream, blocks[index].entities.data(), blocks[index].entities.size_bytes());
+			Pad(stream, block_headers[index].payload_offset);
+			Write(stream, blocks[index].payload.data(), blocks[index].payload.size());
+		}
+
+		return static_cast<bool>(stream);
+	}
+
+	// Replaces the world entities and components, pools of the components
+	// which aren't in the file are cleared. Blocks are validated and decoded
+	// before the world is changed, so the invalid file leaves it as is. Only
+	// the world Restored event is sent.
+	bool Load(World& world, const std::filesystem::path& path) const {
+		AOE_ASSERT_MSG(world.storage_ == WorldStorage::kSparseSet, "Archetype storage doesn't support serialization.");
+		AOE_ASSERT_MSG(world.GetDeferredCommands() == nullptr, "Can't load in parallel section.");
+
+		MappedFile file(path);
+		FileHeader header{};
+
+		if (!file.IsOpen() || !IsInside(file, 0, 1, sizeof(FileHeader))) {
+			return false;
+		}
+
+		std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+
+		bool is_valid = header.magic == kMagic
+			&& header.version == kVersion
+			&& IsInside(file, sizeof(FileHeader), header.blocks_count, sizeof(BlockHeader))
+			&& IsArrayInside(file, header.entities_offset, header.entities_count, sizeof(Entity))
+			&& header.bound >= 0
+			&& static_cast<uint64_t>(header.bound) <= header.entities_count;
+
+		if (!is_valid) {
+			return false;
+		}
+
+		std::span<const Entity> entities(reinterpret_cast<const Entity*>(file.GetData() + header.entities_offset), header.entities_count);
+		std::vector<EntityId> lookups;
+
+		if (!AreEntitiesValid(entities, header.retired_count, lookups)) {
+			return false;
+		}
+
+		std::vector<BlockHeader> block_headers(header.blocks_count);
+		std::memcpy(block_headers.data(), file.GetData() + sizeof(FileHeader), sizeof(BlockHeader) * header.blocks_count);
+
+		std::vector<std::unique_ptr<IDecodedBlock>> decoded_blocks;
+		decoded_blocks.reserve(block_headers.size());
+		std::vector<uint64_t> marks(lookups.size(), 0);
+
+		for (size_t index = 0; index < block_headers.size(); ++index) {
+			const BlockHeader& block_header = block_headers[index];
+			bool is_inside = IsArrayInside(file, block_header.entities_offset, block_header.count, sizeof(Entity))
+				&& IsArrayInside(file, block_header.payload_offset, block_header.payload_size, 1);
+
+			if (!is_inside) {
+				return false;
+			}
+
+			std::span<const Entity> block_entities(
+				reinterpret_cast<const Entity*>(file.GetData() + block_header.entities_offset),
+				block_header.count);
+
+			if (!AreBlockEntitiesValid(block_entities, entities, header.bound, lookups, marks, index + 1)) {
+				return false;
+			}
+
+			const Codec* codec = FindCodec(block_header);
+
+			if (codec == nullptr) {
+				continue;
+			}
+
+			decoded_blocks.push_back(codec->decode(block_header, file.GetData()));
+
+			if (decoded_blocks.back() == nullptr) {
+				return false;
+			}
+		}
+
+		world.entities_pool_.Assign(entities, header.bound, header.retired_count);
+
+		for (IComponentsPool* pool : world.component_pools_) {
+			if (pool != nullptr) {
+				pool->Restore(nullptr);
+			}
+		}
+
+		for (const std::unique_ptr<IDecodedBlock>& decoded_block : decoded_blocks) {
+			decoded_block->Assign(world);
+		}
+
+		world.OnRestored();
+		return true;
+	}
+
+private:
+	static constexpr uint32_t kMagic = 0x574F4541;
+	static constexpr uint32_t kVersion = 1;
+	static constexpr uint64_t kAlignment = 64;
+	static constexpr size_t kNameSize = 128;
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t blocks_count;
+		uint64_t entities_count;
+		uint64_t entities_offset;
+		uint64_t retired_count;
+		int32_t bound;
+		uint32_t padding;
+	};
+
+	struct BlockHeader {
+		char name[kNameSize];
+		uint32_t is_trivial;
+		uint32_t element_size;
+		uint64_t count;
+		uint64_t entities_offset;
+		uint64_t payload_offset;
+		uint64_t payload_size;
+	};
+
+	// Entities point to the pool, payload is the copy of the components.
+	struct Block {
+		std::span<const Entity> entities;
+		std::vector<std::byte> payload;
+		uint32_t is_trivial = 0;
+		uint32_t element_size = 0;
+	};
+
+	// Components of the valid block, which are ready to be assigned.
+	class IDecodedBlock {
+	public:
+		virtual ~IDecodedBlock() = default;
+
+		virtual void Assign(World& world) const = 0;
+	};
+
+	// Trivially copyable components point to the file, reflected ones are
+	// read to the storage.
+	template<typename TComponent>
+	class DecodedBlock : public IDecodedBlock {
+	public:
+		DecodedBlock(std::span<const Entity> entities, std::span<const TComponent> components)
+			: entities_(entities)
+			, components_(components)
+			, storage_()
+		{}
+
+		DecodedBlock(std::span<const Entity> entities, std::vector<TComponent> storage)
+			: entities_(entities)
+			, components_()
+			, storage_(std::move(storage))
+		{
+			components_ = storage_;
+		}
+
+		void Assign(World& world) const override {
+			world.GetOrCreatePool<TComponent>()->Assign(entities_, components_);
+		}
+
+	private:
+		std::span<const Entity> entities_;
+		std::span<const TComponent> components_;
+		std::vector<TComponent> storage_;
+	};
+
+	struct Codec {
+		using Save = void(*)(const World& world, Block& block);
+		using Decode = std::unique_ptr<IDecodedBlock>(*)(const BlockHeader& block_header, const std::byte* data);
+
+		std::string name;
+		Save save;
+		Decode decode;
+	};
+
+	std::vector<Codec> codecs_;
+
+	template<typename TComponent>
+	static void SaveComponents(const World& world, Block& block) {
+		ComponentsPool<TComponent>* pool = world.GetPool<TComponent>();
+
+		if constexpr (std::is_trivially_copyable_v<TComponent>) {
+			block.is_trivial = 1;
+			block.element_size = sizeof(TComponent);
+		}
+
+		if (pool == nullptr) {
+			return;
+		}
+
+		block.entities = pool->GetEntities();
+
+		if constexpr (std::is_trivially_copyable_v<TComponent>) {
+			if constexpr (ComponentTraits<TComponent>::kIsStable) {
+				for (size_t index = 0; index < pool->GetSize(); ++index) {
+					const std::byte* bytes = reinterpret_cast<const std::byte*>(&pool->GetByIndex(index));
+					block.payload.insert(block.payload.end(), bytes, bytes + sizeof(TComponent));
+				}
+			} else {
+				std::span<const std::byte> bytes = std::as_bytes(pool->GetComponents());
+				block.payload.assign(bytes.begin(), bytes.end());
+			}
+		} else {
+			const Type* type = Reflector::GetType<TComponent>();
+
+			for (size_t index = 0; index < pool->GetSize(); ++index) {
+				WriteObject(type, &pool->GetByIndex(index), block.payload);
+			}
+		}
+	}
+
+	// Returns null if the block doesn't match the component.
+	template<typename TComponent>
+	static std::unique_ptr<IDecodedBlock> DecodeComponents(const BlockHeader& block_header, const std::byte* data) {
+		std::span<const Entity> entities(reinterpret_cast<const Entity*>(data + block_header.entities_offset), block_header.count);
+
+		if constexpr (std::is_trivially_copyable_v<TComponent>) {
+			bool is_valid = block_header.is_trivial == 1
+				&& block_header.element_size == sizeof(TComponent)
+				&& block_header.payload_size == sizeof(TComponent) * block_header.count;
+
+			if (!is_valid) {
+				return nullptr;
+			}
+
+			std::span<const TComponent> components(reinterpret_cast<const TComponent*>(data + block_header.payload_offset), block_header.count);
+			return std::make_unique<DecodedBlock<TComponent>>(entities, components);
+		} else {
+			if (block_header.is_trivial != 0) {
+				return nullptr;
+			}
+
+			const Type* type = Reflector::GetType<TComponent>();
+			const std::byte* payload = data + block_header.payload_offset;
+			const std::byte* payload_end = payload + block_header.payload_size;
+			std::vector<TComponent> components(block_header.count);
+
+			for (TComponent& component : components) {
+				if (!ReadObject(type, &component, payload, payload_end)) {
+					return nullptr;
+				}
+			}
+
+			return std::make_unique<DecodedBlock<TComponent>>(entities, std::move(components));
+		}
+	}
+
+	// Base classes keep no offsets of their subobjects, so their fields can't
+	// be reached and types expanded field by field mustn't have bases.
+	static void AssertSerializable(const Type* type) {
+		if (type->GetFields().empty()) {
+			AOE_ASSERT_MSG(type->IsTriviallyCopyable(), "Field type isn't trivially copyable.");
+			return;
+		}
+
+		AOE_ASSERT_MSG(type->GetBaseClasses().empty(), "Serialized type has base classes.");
+
+		for (const Field* field : type->GetFields()) {
+			AssertSerializable(field->GetType());
+		}
+	}
+
+	static void WriteObject(const Type* type, const void* object, std::vector<std::byte>& payload) {
+		if (type->GetFields().empty()) {
+			const std::byte* bytes = static_cast<const std::byte*>(object);
+			payload.insert(payload.end(), bytes, bytes + type->GetSize());
+			return;
+		}
+
+		for (const Field* field : type->GetFields()) {
+			WriteObject(field->GetType(), field->GetValue(const_cast<void*>(object)), payload);
+		}
+	}
+
+	static bool ReadObject(const Type* type, void* object, const std::byte*& payload, const std::byte* payload_end) {
+		if (type->GetFields().empty()) {
+			if (static_cast<size_t>(payload_end - payload) < type->GetSize()) {
+				return false;
+			}
+
+			std::memcpy(object, payload, type->GetSize());
+			payload += type->GetSize();
+			return true;
+		}
+
+		for (const Field* field : type->GetFields()) {
+			if (!ReadObject(field->GetType(), field->GetValue(object), payload, payload_end)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const Codec* FindCodec(const BlockHeader& block_header) const {
+		std::string name(block_header.name, strnlen(block_header.name, kNameSize));
+
+		for (const Codec& codec : codecs_) {
+			if (codec.name == name) {
+				return &codec;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static uint64_t Align(uint64_t offset) {
+		return (offset + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	// Counts come from the file, so they aren't multiplied by the sizes.
+	static bool IsInside(const MappedFile& file, uint64_t offset, uint64_t count, uint64_t element_size) {
+		return offset <= file.GetSize() && count <= (file.GetSize() - offset) / element_size;
+	}
+
+	// Arrays are read in place, so they start at aligned offsets.
+	static bool IsArrayInside(const MappedFile& file, uint64_t offset, uint64_t count, uint64_t element_size) {
+		return offset % kAlignment == 0 && IsInside(file, offset, count, element_size);
+	}
+
+	// Ids of the entities are unique and below the entities and the retired
+	// ids count, since the new ids continue after them. Lookups map ids to
+	// the entities indices.
+	static bool AreEntitiesValid(
+		std::span<const Entity> entities,
+		uint64_t retired_count,
+		std::vector<EntityId>& lookups)
+	{
+		const uint64_t ids_count = static_cast<uint64_t>(kMaxEntityId) + 1;
+
+		if (entities.size() > ids_count || retired_count > ids_count - entities.size()) {
+			return false;
+		}
+
+		lookups.assign(entities.size() + retired_count, kNullEntityId);
+
+		for (size_t index = 0; index < entities.size(); ++index) {
+			Entity entity = entities[index];
+
+			bool is_valid = entity.GetId() >= 0
+				&& entity.GetVersion() >= 0
+				&& static_cast<size_t>(entity.GetId()) < lookups.size()
+				&& lookups[entity.GetId()] == kNullEntityId;
+
+			if (!is_valid) {
+				return false;
+			}
+
+			lookups[entity.GetId()] = static_cast<EntityId>(index);
+		}
+
+		return true;
+	}
+
+	// Block entities are alive and not repeated, marks of the previous
+	// blocks differ from the block mark.
+	static bool AreBlockEntitiesValid(
+		std::span<const Entity> block_entities,
+		std::span<const Entity> entities,
+		EntityId bound,
+		const std::vector<EntityId>& lookups,
+		std::vector<uint64_t>& marks,
+		uint64_t mark)
+	{
+		for (Entity entity : block_entities) {
+			if (entity.GetId() < 0 || static_cast<size_t>(entity.GetId()) >= lookups.size()) {
+				return false;
+			}
+
+			EntityId lookup = lookups[entity.GetId()];
+			uint64_t& entity_mark = marks[entity.GetId()];
+
+			if (lookup == kNullEntityId || lookup >= bound || entities[lookup] != entity || entity_mark == mark) {
+				return false;
+			}
+
+			entity_mark = mark;
+		}
+
+		return true;
+	}
+
+	static void Write(std::ofstream& stream, const void* data, size_t size) {
+		stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}
+
+	static void Pad(std::ofstream& stream, uint64_t offset) {
+		static const char kZeros[kAlignment] = {};
+		uint64_t position = static_cast<uint64_t>(stream.tellp());
+		Write(stream, kZeros, static_cast<size_t>(offset - position));
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+
+#include "EntitiesPool.h"
+#include "IComponentsPool.h"
+
+namespace aoe {
+
+// Copy of the world entities and components, see World::Snapshot.
+class WorldSnapshot {
+AOE_NON_COPYABLE_CLASS(WorldSnapshot)
+
+private:
+	friend class World;
+
+public:
+	using ComponentsSnapshots = std::vector<std::unique_ptr<IComponentsSnapshot>>;
+
+	WorldSnapshot(WorldSnapshot&&) = default;
+	WorldSnapshot& operator=(WorldSnapshot&&) = default;
+
+private:
+	EntitiesSnapshot entities_;
+	ComponentsSnapshots components_;
+
+	WorldSnapshot(EntitiesSnapshot entities, ComponentsSnapshots components)
+		: entities_(std::move(entities))
+		, components_(std::move(components))
+	{}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/Debug.h"
+
+#include "World.h"
+
+namespace aoe {
+
+template<typename TComponent>
+struct Read {};
+
+template<typename TComponent>
+struct Write {};
+
+template<typename TAccess>
+struct Access;
+
+template<typename TComponent>
+struct Access<Read<TComponent>> {
+	using Component = TComponent;
+
+	static constexpr bool kIsWritable = false;
+};
+
+template<typename TComponent>
+struct Access<Write<TComponent>> {
+	using Component = TComponent;
+
+	static constexpr bool kIsWritable = true;
+};
+
+// Access to the declared components only, which is checked at compile time.
+// Views which don't overlap in written components can be used from different
+// threads, as long as nobody changes the world structure. Debug build asserts
+// that alive views of the world don't overlap.
+template<typename ...TAccesses>
+class WorldView {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(WorldView)
+
+public:
+	template<typename TComponent>
+	static constexpr bool kIsReadable = (std::is_same_v<TComponent, typename Access<TAccesses>::Component> || ...);
+
+	template<typename TComponent>
+	static constexpr bool kIsWritable = ((std::is_same_v<TComponent, typename Access<TAccesses>::Component>
+		&& Access<TAccesses>::kIsWritable) || ...);
+
+	// Changed terms of the view match changes after the tick.
+	WorldView(World& world, ChangeTick since = 0)
+		: world_(&world)
+		, since_(since)
+	{
+#ifndef NDEBUG
+		(Acquire<TAccesses>(), ...);
+#endif // !NDEBUG
+	}
+
+	~WorldView() {
+#ifndef NDEBUG
+		(Release<TAccesses>(), ...);
+#endif // !NDEBUG
+	}
+
+	bool IsEntityValid(Entity entity) const {
+		return world_->IsEntityValid(entity);
+	}
+
+	template<typename TComponent>
+	bool HasComponent(Entity entity) const {
+		static_assert(kIsReadable<TComponent>, "Component isn't declared by the view.");
+		return world_->HasComponent<TComponent>(entity);
+	}
+
+	// Returns the mutable component for the written one and marks it as changed.
+	template<typename TComponent>
+	auto GetComponent(Entity entity) const {
+		static_assert(kIsReadable<TComponent>, "Component isn't declared by the view.");
+		ComponentsPool<TComponent>* pool = world_->GetPool<TComponent>();
+
+		if constexpr (kIsWritable<TComponent>) {
+			TComponent* component = pool != nullptr ? pool->Get(entity) : nullptr;
+
+			if (component != nullptr) {
+				pool->MarkChanged(entity);
+			}
+
+			return component;
+		} else {
+			const ComponentsPool<TComponent>* const_pool = pool;
+			return const_pool != nullptr ? const_pool->Get(entity) : nullptr;
+		}
+	}
+
+	// Function may take only written components as non-const references.
+	template<typename ...TTerms, typename TFunction>
+	void ForEach(TFunction function) const {
+		static_assert((kIsReadable<TermComponent<TTerms>> && ...), "Component isn't declared by the view.");
+		static_assert(
+			IsWriteAllowed<TFunction, TTerms...>(std::index_sequence_for<TTerms...>()),
+			"Component isn't declared as written by the view.");
+
+		world_->ForEach<TTerms...>(function, since_);
+	}
+
+private:
+	World* world_;
+	ChangeTick since_;
+
+	template<typename TFunction, typename ...TTerms, size_t ...TIndices>
+	static constexpr bool IsWriteAllowed(std::index_sequence<TIndices...> indices) {
+		return ((!IsTermWritten<TFunction, TIndices, TTerms...>(indices) || kIsWritable<TermComponent<TTerms>>) && ...);
+	}
+
+	template<typename TAccess>
+	void Acquire() {
+		TypeId type_id = World::ECSIdentifier::GetTypeId<typename Access<TAccess>::Component>();
+
+		if constexpr (Access<TAccess>::kIsWritable) {
+			AOE_ASSERT_MSG(world_->access_checker_.TryAcquireWrite(type_id), "Component is accessed by another view.");
+		} else {
+			AOE_ASSERT_MSG(world_->access_checker_.TryAcquireRead(type_id), "Component is written by another view.");
+		}
+	}
+
+	template<typename TAccess>
+	void Release() {
+		TypeId type_id = World::ECSIdentifier::GetTypeId<typename Access<TAccess>::Component>();
+
+		if constexpr (Access<TAccess>::kIsWritable) {
+			world_->access_checker_.ReleaseWrite(type_id);
+		} else {
+			world_->access_checker_.ReleaseRead(type_id);
+		}
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
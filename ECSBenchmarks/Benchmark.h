@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace aoe_benchmarks {
+
+struct BenchmarkResult {
+	std::string name;
+	std::string suite;
+	size_t entities_count;
+	double milliseconds;
+};
+
+// Collects the results to compare runs, see WriteJson.
+class BenchmarkReport {
+public:
+	BenchmarkReport()
+		: results_()
+	{}
+
+	void Add(BenchmarkResult result) {
+		std::cerr << result.suite << " [" << result.entities_count << "] "
+			<< result.name << ": " << result.milliseconds << " ms" << std::endl;
+
+		results_.push_back(std::move(result));
+	}
+
+	void WriteJson(std::ostream& stream) const {
+		stream << "{\n\t\"benchmarks\": [";
+
+		for (size_t index = 0; index < results_.size(); ++index) {
+			const BenchmarkResult& result = results_[index];
+
+			stream << (index == 0 ? "\n" : ",\n")
+				<< "\t\t{ \"name\": \"" << result.name
+				<< "\", \"suite\": \"" << result.suite
+				<< "\", \"entities\": " << result.entities_count
+				<< ", \"ms\": " << result.milliseconds << " }";
+		}
+
+		stream << "\n\t]\n}" << std::endl;
+	}
+
+private:
+	std::vector<BenchmarkResult> results_;
+};
+
+// Measures the scope and adds the result to the report.
+class Benchmark {
+public:
+	Benchmark(BenchmarkReport& report, std::string name, std::string suite, size_t entities_count)
+		: report_(report)
+		, result_({ std::move(name), std::move(suite), entities_count, 0.0 })
+		, start_(Clock::now())
+	{}
+
+	~Benchmark() {
+		auto duration = std::chrono::duration<double, std::milli>(Clock::now() - start_);
+		result_.milliseconds = duration.count();
+		report_.Add(std::move(result_));
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	BenchmarkReport& report_;
+	BenchmarkResult result_;
+	Clock::time_point start_;
+};
+
+// Keeps the compiler from throwing away the benchmarked work.
+template<typename T>
+void DoNotOptimize(const T& value) {
+	static volatile const void* sink;
+	sink = &value;
+}
+
+} // namespace aoe_benchmarks
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "../ECS/World.h"
+#include "../Game/Relationeer.h"
+#include "../Game/Transform.h"
+#include "../Game/TransformBatch.h"
+
+#include "Benchmark.h"
+
+using namespace aoe_benchmarks;
+
+struct Position {
+	float x;
+	float y;
+	float z;
+};
+
+struct Velocity {
+	float x;
+	float y;
+	float z;
+};
+
+struct Health {
+	int value;
+};
+
+struct Marker {
+	int value;
+};
+
+struct EventsCounter {
+	size_t count = 0;
+
+	void OnComponentAdded(aoe::Entity entity) {
+		count += 1;
+	}
+};
+
+std::string GetName(aoe::WorldStorage storage) {
+	return storage == aoe::WorldStorage::kArchetype ? "archetype" : "sparse set";
+}
+
+void RunBenchmarks(BenchmarkReport& report, aoe::ThreadPool& pool, aoe::WorldStorage storage, size_t entities_count) {
+	std::string storage_name = GetName(storage);
+	aoe::World world(storage);
+	std::vector<aoe::Entity> entities;
+
+	auto measure = [&](std::string name) {
+		return Benchmark(report, std::move(name), storage_name, entities_count);
+	};
+
+	{
+		auto benchmark = measure("create");
+
+		for (size_t count = 0; count < entities_count; ++count) {
+			entities.push_back(world.CreateEntity());
+		}
+	}
+
+	{
+		auto benchmark = measure("add");
+
+		for (size_t index = 0; index < entities.size(); ++index) {
+			world.AddComponent<Position>(entities[index], 0.0f, 0.0f, 0.0f);
+			world.AddComponent<Velocity>(entities[index], 1.0f, 1.0f, 1.0f);
+
+			if (index % 2 == 0) {
+				world.AddComponent<Health>(entities[index], 100);
+			}
+		}
+	}
+
+	{
+		std::vector<aoe::Entity> shuffled = entities;
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+		auto benchmark = measure("get component random");
+		float sum = 0.0f;
+
+		for (aoe::Entity entity : shuffled) {
+			sum += world.GetComponent<Position>(entity)->x;
+		}
+
+		DoNotOptimize(sum);
+	}
+
+	{
+		auto benchmark = measure("for each single");
+
+		world.ForEach<Position>([](aoe::Entity entity, Position& position) {
+			position.x += 1.0f;
+		});
+	}
+
+	{
+		auto benchmark = measure("for each multi");
+
+		world.ForEach<Position, Velocity>([](aoe::Entity entity, Position& position, Velocity& velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+			position.z += velocity.z;
+		});
+	}
+
+	{
+		auto benchmark = measure("parallel for each");
+
+		world.ParallelForEach<Position, Velocity>(pool, [](aoe::Entity entity, Position& position, Velocity& velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+			position.z += velocity.z;
+		});
+	}
+
+	{
+		auto benchmark = measure("filter single");
+		size_t count = 0;
+
+		for (aoe::Entity entity : world.FilterEntities<Position>()) {
+			count += 1;
+		}
+
+		DoNotOptimize(count);
+	}
+
+	{
+		auto benchmark = measure("filter multi");
+
+		for (aoe::Entity entity : world.FilterEntities<Position, Velocity, Health>()) {
+			auto health = world.GetComponent<Health>(entity);
+			health->value -= 1;
+		}
+	}
+
+	{
+		auto benchmark = measure("view");
+		float sum = 0.0f;
+
+		for (auto [entity, position] : world.ViewComponents<Position>()) {
+			sum += position.x;
+		}
+
+		DoNotOptimize(sum);
+	}
+
+	{
+		EventsCounter counter;
+		world.ComponentAdded<Marker>().Attach(counter, &EventsCounter::OnComponentAdded);
+
+		{
+			auto benchmark = measure("add with event");
+
+			for (aoe::Entity entity : entities) {
+				world.AddComponent<Marker>(entity, 0);
+			}
+		}
+
+		world.ComponentAdded<Marker>().Detach(counter, &EventsCounter::OnComponentAdded);
+		DoNotOptimize(counter.count);
+	}
+
+	{
+		auto benchmark = measure("remove");
+
+		for (aoe::Entity entity : entities) {
+			world.RemoveComponent<Velocity>(entity);
+		}
+	}
+
+	{
+		auto benchmark = measure("add batched");
+		world.AddComponents<Velocity>(entities, 1.0f, 1.0f, 1.0f);
+	}
+
+	{
+		auto benchmark = measure("remove batched");
+		world.RemoveComponents<Velocity>(entities);
+	}
+
+	{
+		auto benchmark = measure("destroy");
+
+		for (aoe::Entity entity : entities) {
+			world.DestroyEntity(entity);
+		}
+
+		world.Validate();
+	}
+}
+
+// Compares composing parent * local matrices one by one and in batch, the
+// batch writes both 4x4 and 3x4 matrices.
+void RunTransformBenchmarks(BenchmarkReport& report, size_t transforms_count) {
+	static_assert(sizeof(aoe::Matrix4f) == 16 * sizeof(float), "Matrix isn't tightly packed.");
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	auto get_vector = [&]() {
+		return aoe::Vector3f(distribution(random), distribution(random), distribution(random));
+	};
+
+	std::vector<aoe::Transform> transforms;
+	std::vector<aoe::Matrix4f> parents;
+	std::vector<aoe::Matrix4f> globals(transforms_count);
+	std::vector<aoe::Affine3x4f> affine_parents;
+	std::vector<aoe::Affine3x4f> affine_globals(transforms_count);
+	std::vector<float> columns[10];
+
+	for (size_t index = 0; index < transforms_count; ++index) {
+		aoe::Vector3f position = get_vector();
+		aoe::Quaternion rotation = aoe::Quaternion::FromEulerAngles(get_vector());
+		aoe::Vector3f scale = get_vector() + aoe::Vector3f(2.0f, 2.0f, 2.0f);
+
+		transforms.emplace_back(position, rotation, scale);
+		parents.push_back(aoe::Matrix4f::FromTranslationVector(get_vector()));
+		affine_parents.emplace_back(parents.back());
+
+		const float values[] = {
+			position[0], position[1], position[2],
+			rotation.vector()[0], rotation.vector()[1], rotation.vector()[2], rotation.scalar(),
+			scale[0], scale[1], scale[2],
+		};
+
+		for (size_t column = 0; column < std::size(columns); ++column) {
+			columns[column].push_back(values[column]);
+		}
+	}
+
+	aoe::TransformArrays arrays = {
+		columns[0].data(), columns[1].data(), columns[2].data(),
+		columns[3].data(), columns[4].data(), columns[5].data(), columns[6].data(),
+		columns[7].data(), columns[8].data(), columns[9].data(),
+	};
+
+	{
+		auto benchmark = Benchmark(report, "to matrix", "transform", transforms_count);
+
+		for (size_t index = 0; index < transforms_count; ++index) {
+			globals[index] = parents[index] * transforms[index].ToMatrix();
+		}
+
+		DoNotOptimize(globals);
+	}
+
+	{
+		auto benchmark = Benchmark(report, "batch compose", "transform", transforms_count);
+
+		aoe::TransformBatch::Compose(
+			arrays,
+			reinterpret_cast<const float*>(parents.data()),
+			reinterpret_cast<float*>(globals.data()),
+			transforms_count);
+
+		DoNotOptimize(globals);
+	}
+
+	{
+		auto benchmark = Benchmark(report, "batch compose affine", "transform", transforms_count);
+		aoe::TransformBatch::Compose(arrays, affine_parents.data(), affine_globals.data(), transforms_count);
+		DoNotOptimize(affine_globals);
+	}
+}
+
+// Moves all the nodes between two parents, then makes them roots.
+void RunRelationeerBenchmarks(BenchmarkReport& report, size_t nodes_count) {
+	aoe::World world;
+	aoe::Relationeer<Position> relationeer(world);
+	std::vector<aoe::Entity> nodes;
+
+	for (size_t count = 0; count < nodes_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<Position>(entity, 0.0f, 0.0f, 0.0f);
+		nodes.push_back(entity);
+	}
+
+	aoe::Entity first_parent = world.CreateEntity();
+	world.AddComponent<Position>(first_parent, 0.0f, 0.0f, 0.0f);
+	aoe::Entity second_parent = world.CreateEntity();
+	world.AddComponent<Position>(second_parent, 0.0f, 0.0f, 0.0f);
+
+	{
+		auto benchmark = Benchmark(report, "set parent", "relationeer", nodes_count);
+
+		for (aoe::Entity node : nodes) {
+			relationeer.SetParent(node, first_parent);
+		}
+	}
+
+	{
+		auto benchmark = Benchmark(report, "re-parent", "relationeer", nodes_count);
+
+		for (aoe::Entity node : nodes) {
+			relationeer.SetParent(node, second_parent);
+		}
+	}
+
+	{
+		auto benchmark = Benchmark(report, "make root", "relationeer", nodes_count);
+
+		for (aoe::Entity node : nodes) {
+			relationeer.MakeRoot(node);
+		}
+	}
+}
+
+// Writes JSON results to the file passed as the first argument or to the output.
+int main(int argc, char* argv[]) {
+	aoe::ThreadPool pool;
+	BenchmarkReport report;
+
+	for (size_t entities_count : { 10'000, 100'000, 1'000'000 }) {
+		RunBenchmarks(report, pool, aoe::WorldStorage::kSparseSet, entities_count);
+		RunBenchmarks(report, pool, aoe::WorldStorage::kArchetype, entities_count);
+		RunTransformBenchmarks(report, entities_count);
+	}
+
+	RunRelationeerBenchmarks(report, 10'000);
+
+	if (argc > 1) {
+		std::ofstream stream(argv[1]);
+		report.WriteJson(stream);
+	} else {
+		report.WriteJson(std::cout);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "pch.h"
+
+#include "../ECS/AccessChecker.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+TEST(AccessCheckerTests, TryAcquireRead_ReadReadComponent_Acquired) {
+	aoe::AccessChecker checker;
+
+	ASSERT_TRUE(checker.TryAcquireRead(0));
+	ASSERT_TRUE(checker.TryAcquireRead(0));
+	ASSERT_FALSE(checker.TryAcquireWrite(0));
+	ASSERT_TRUE(checker.TryAcquireWrite(1));
+}
+
+TEST(AccessCheckerTests, TryAcquireWrite_WriteReleasedComponent_Acquired) {
+	aoe::AccessChecker checker;
+
+	ASSERT_TRUE(checker.TryAcquireWrite(0));
+	ASSERT_FALSE(checker.TryAcquireWrite(0));
+	ASSERT_FALSE(checker.TryAcquireRead(0));
+
+	checker.ReleaseWrite(0);
+
+	ASSERT_TRUE(checker.TryAcquireRead(0));
+	checker.ReleaseRead(0);
+	ASSERT_TRUE(checker.TryAcquireWrite(0));
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
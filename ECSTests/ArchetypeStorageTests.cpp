@@ -0,0 +1,93 @@
+#include "pch.h"
+
+#include <string>
+#include <unordered_set>
+
+#include "../ECS/ArchetypeStorage.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+struct Position {
+	float x;
+	float y;
+};
+
+struct Name {
+	std::string value;
+};
+
+TEST(ArchetypeStorageTests, Get_GetEmplacedComponent_EmplacedComponent) {
+	aoe::ArchetypeStorage storage;
+	aoe::Entity entity(0);
+
+	storage.Emplace<Position>(entity, 1.0f, 2.0f);
+	Position* position = storage.Get<Position>(entity);
+
+	ASSERT_TRUE(position != nullptr);
+	ASSERT_EQ(position->x, 1.0f);
+	ASSERT_EQ(position->y, 2.0f);
+}
+
+TEST(ArchetypeStorageTests, Has_EmplaceAndRemoveComponent_False) {
+	aoe::ArchetypeStorage storage;
+	aoe::Entity entity(0);
+
+	storage.Emplace<Position>(entity);
+	storage.Remove<Position>(entity);
+	bool has = storage.Has<Position>(entity);
+
+	ASSERT_FALSE(has);
+	ASSERT_TRUE(storage.Get<Position>(entity) == nullptr);
+}
+
+TEST(ArchetypeStorageTests, Remove_RemoveOneOfComponents_OtherComponentsAreKept) {
+	const aoe::EntityId entities_count = 1000;
+	aoe::ArchetypeStorage storage;
+
+	for (aoe::EntityId id = 0; id < entities_count; ++id) {
+		aoe::Entity entity(id);
+		storage.Emplace<Position>(entity, static_cast<float>(id), 0.0f);
+		storage.Emplace<Name>(entity, std::to_string(id));
+	}
+
+	for (aoe::EntityId id = 0; id < entities_count; id += 2) {
+		storage.Remove<Position>(aoe::Entity(id));
+	}
+
+	for (aoe::EntityId id = 0; id < entities_count; ++id) {
+		aoe::Entity entity(id);
+		Name* name = storage.Get<Name>(entity);
+
+		ASSERT_TRUE(name != nullptr);
+		ASSERT_EQ(name->value, std::to_string(id));
+		ASSERT_EQ(storage.Has<Position>(entity), id % 2 != 0);
+	}
+}
+
+TEST(ArchetypeStorageTests, ForEach_IterateOverMatchedEntities_AllMatchedEntitiesIterated) {
+	const aoe::EntityId entities_count = 1000;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::ArchetypeStorage storage;
+
+	for (aoe::EntityId id = 0; id < entities_count; ++id) {
+		aoe::Entity entity(id);
+		storage.Emplace<Position>(entity, static_cast<float>(id), 0.0f);
+
+		if (id % 3 == 0) {
+			storage.Emplace<Name>(entity, std::to_string(id));
+			expected_entities.insert(entity);
+		}
+	}
+
+	storage.ForEach<Position, Name>([&](aoe::Entity entity, Position& position, Name& name) {
+		ASSERT_EQ(name.value, std::to_string(entity.GetId()));
+		ASSERT_EQ(position.x, static_cast<float>(entity.GetId()));
+		expected_entities.erase(entity);
+	});
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "pch.h"
+
+#include "../ECS/World.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+struct CommandTestComponent {
+	int value;
+};
+
+class AddedComponentsCounter {
+public:
+	size_t count = 0;
+	size_t batches_count = 0;
+
+	void OnComponentAdded(aoe::Entity /*entity*/) {
+		count += 1;
+	}
+
+	void OnComponentsAdded(std::span<const aoe::Entity> /*entities*/) {
+		batches_count += 1;
+	}
+};
+
+TEST(CommandBufferTests, Validate_CreateEntityAndAddComponent_EntityCreatedWithComponent) {
+	aoe::World world;
+	aoe::CommandBuffer& commands = world.GetCommandBuffer();
+
+	aoe::Entity placeholder = commands.CreateEntity();
+	commands.AddComponent<CommandTestComponent>(placeholder, 42);
+	world.Validate();
+
+	auto entities = world.FilterEntities<CommandTestComponent>();
+	auto it = entities.begin();
+
+	ASSERT_NE(it, entities.end());
+	ASSERT_TRUE(world.IsEntityValid(*it));
+	ASSERT_EQ(world.GetComponent<CommandTestComponent>(*it)->value, 42);
+	ASSERT_TRUE(commands.IsEmpty());
+}
+
+TEST(CommandBufferTests, Flush_AddAndRemoveComponent_OnlyLastCommandApplied) {
+	aoe::World world;
+	aoe::CommandBuffer commands;
+	AddedComponentsCounter counter;
+	aoe::Entity entity = world.CreateEntity();
+
+	world.ComponentAdded<CommandTestComponent>().Attach(counter, &AddedComponentsCounter::OnComponentAdded);
+	commands.AddComponent<CommandTestComponent>(entity, 1);
+	commands.RemoveComponent<CommandTestComponent>(entity);
+	commands.AddComponent<CommandTestComponent>(entity, 3);
+	world.Flush(commands);
+
+	ASSERT_EQ(counter.count, 1);
+	ASSERT_EQ(world.GetComponent<CommandTestComponent>(entity)->value, 3);
+}
+
+TEST(CommandBufferTests, Validate_RecordCommandsDuringIteration_CommandsAppliedAfterIteration) {
+	const size_t entities_count = 100;
+	aoe::World world;
+	aoe::CommandBuffer& commands = world.GetCommandBuffer();
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<CommandTestComponent>(entity, static_cast<int>(count));
+	}
+
+	size_t visited_count = 0;
+
+	for (aoe::Entity entity : world.FilterEntities<CommandTestComponent>()) {
+		if (world.GetComponent<CommandTestComponent>(entity)->value % 2 == 0) {
+			commands.DestroyEntity(entity);
+		} else {
+			commands.RemoveComponent<CommandTestComponent>(entity);
+		}
+
+		visited_count += 1;
+	}
+
+	world.Validate();
+
+	ASSERT_EQ(visited_count, entities_count);
+	ASSERT_EQ(world.FilterEntities<CommandTestComponent>().begin(), world.FilterEntities<CommandTestComponent>().end());
+}
+
+TEST(CommandBufferTests, Validate_AttachedBuffer_BufferFlushed) {
+	aoe::World world;
+	aoe::CommandBuffer commands;
+	aoe::Entity entity = world.CreateEntity();
+
+	world.AttachCommandBuffer(&commands);
+	commands.AddComponent<CommandTestComponent>(entity, 1);
+	world.Validate();
+	world.DetachCommandBuffer(&commands);
+
+	ASSERT_TRUE(world.HasComponent<CommandTestComponent>(entity));
+}
+
+TEST(CommandBufferTests, Flush_AddComponentsToManyEntities_AddedWithSingleBatch) {
+	aoe::World world;
+	aoe::CommandBuffer commands;
+	AddedComponentsCounter counter;
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+
+	world.ComponentAdded<CommandTestComponent>().Attach(counter, &AddedComponentsCounter::OnComponentAdded);
+	world.ComponentsAdded<CommandTestComponent>().Attach(counter, &AddedComponentsCounter::OnComponentsAdded);
+
+	for (size_t index = 0; index < entities.size(); ++index) {
+		commands.AddComponent<CommandTestComponent>(entities[index], static_cast<int>(index));
+	}
+
+	world.Flush(commands);
+
+	ASSERT_EQ(counter.count, entities.size());
+	ASSERT_EQ(counter.batches_count, 1);
+
+	for (size_t index = 0; index < entities.size(); ++index) {
+		ASSERT_EQ(world.GetComponent<CommandTestComponent>(entities[index])->value, static_cast<int>(index));
+	}
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "pch.h"
+
+#include "../Game/ECSCompositeSystem.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+class CountingSystem : public aoe::ECSSystemBase {
+public:
+	CountingSystem()
+		: updates_count(0)
+	{}
+
+	size_t updates_count;
+
+	void Update(float /*dt*/) override {
+		updates_count += 1;
+		GetWorld()->AddComponent<size_t>(CreateEntity(), updates_count);
+	}
+};
+
+TEST(ECSCompositeSystemTests, Tick_TickInitializedComposite_NestedSystemsUpdated) {
+	aoe::World world;
+	aoe::ServiceProvider service_provider;
+	service_provider.AddService(&world);
+
+	aoe::ECSCompositeSystem composite;
+	composite.PushSystem<CountingSystem>();
+	composite.Initialize(service_provider);
+
+	aoe::ChangeTick tick = world.GetChangeTick();
+	composite.Tick(0.0f);
+	composite.Tick(0.0f);
+	composite.Terminate();
+
+	size_t count = 0;
+
+	world.ForEach<size_t>([&](aoe::Entity /*entity*/, const size_t& /*value*/) {
+		count += 1;
+	});
+
+	ASSERT_EQ(composite.GetWorld(), &world);
+	ASSERT_EQ(count, 2);
+	ASSERT_GT(world.GetChangeTick(), tick);
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
@@ -8,6 +8,31 @@
 namespace aoe_tests {
 namespace ecs_tests {
 
+TEST(EntitiesPoolTests, Destroy_DestroyNotLastEntityWithMaxVersion_OtherEntitiesValid) {
+	aoe::EntitiesPool pool;
+	aoe::Entity entity = pool.Create();
+
+	while (entity.GetVersion() < aoe::kMaxVersion) {
+		pool.Destroy(entity);
+		entity = pool.Create();
+	}
+
+	aoe::Entity alive = pool.Create();
+	pool.Destroy(entity);
+
+	ASSERT_TRUE(pool.IsValid(alive));
+
+	aoe::Entity created = pool.Create();
+
+	ASSERT_EQ(pool.GetRetiredCount(), 1);
+	ASSERT_FALSE(pool.IsValid(entity));
+	ASSERT_TRUE(pool.IsValid(alive));
+	ASSERT_TRUE(pool.IsValid(created));
+	ASSERT_NE(created.GetId(), entity.GetId());
+	ASSERT_NE(created.GetId(), alive.GetId());
+	ASSERT_EQ(pool.GetSize(), 2);
+}
+
 size_t SumOfAp(size_t a_1, size_t a_n, size_t n);
 
 TEST(EntitiesPoolTests, IsValid_CheckIsNotExistedEntityValid_False) {
@@ -104,6 +129,27 @@ TEST(EntitiesPoolTests, Iterator_IterateOverExistedEntities_AllExistedEntitiesIt
 	}
 }
 
+TEST(EntitiesPoolTests, Destroy_DestroyEntityWithMaxVersion_IdRetired) {
+	aoe::EntitiesPool pool;
+	aoe::Entity alive = pool.Create();
+	aoe::Entity entity = pool.Create();
+
+	while (entity.GetVersion() < aoe::kMaxVersion) {
+		pool.Destroy(entity);
+		entity = pool.Create();
+	}
+
+	pool.Destroy(entity);
+	aoe::Entity created = pool.Create();
+
+	ASSERT_EQ(pool.GetRetiredCount(), 1);
+	ASSERT_FALSE(pool.IsValid(entity));
+	ASSERT_TRUE(pool.IsValid(alive));
+	ASSERT_TRUE(pool.IsValid(created));
+	ASSERT_NE(created.GetId(), entity.GetId());
+	ASSERT_NE(created.GetId(), alive.GetId());
+}
+
 size_t SumOfAp(size_t a_1, size_t a_n, size_t n) {
 	return (a_1 + a_n) * n / 2;
 }
@@ -0,0 +1,42 @@
+#include "pch.h"
+
+#include "../ECS/PagedArray.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+using TestPagedArray = aoe::PagedArray<int32_t, -1, 16>;
+
+TEST(PagedArrayTests, Get_GetNotSetValue_NullValue) {
+	TestPagedArray array;
+
+	array.Set(40, 42);
+
+	ASSERT_EQ(array.Get(0), -1);
+	ASSERT_EQ(array.Get(41), -1);
+	ASSERT_EQ(array.Get(1000), -1);
+}
+
+TEST(PagedArrayTests, Set_SetValuesOnDifferentPages_ValuesSet) {
+	TestPagedArray array;
+
+	for (size_t index = 0; index < 100; index += 7) {
+		array.Set(index, static_cast<int32_t>(index));
+	}
+
+	for (size_t index = 0; index < 100; ++index) {
+		int32_t expected = index % 7 == 0 ? static_cast<int32_t>(index) : -1;
+		ASSERT_EQ(array.Get(index), expected);
+	}
+}
+
+TEST(PagedArrayTests, At_AccessNotAllocatedPage_Failure) {
+	TestPagedArray array;
+
+	array.Set(40, 42);
+
+	ASSERT_DEATH(array.At(0), "");
+}
+
+} // ecs_tests
+} // aoe_tests
\ No newline at end of file
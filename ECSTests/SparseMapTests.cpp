@@ -1,5 +1,7 @@
 #include "pch.h"
 
+#include <unordered_set>
+
 #include "../ECS/SparseMap.h"
 
 namespace aoe_tests {
@@ -155,5 +157,52 @@ TEST(SparseMapTests, Remove_AddAndRemoveMultipleIds_HasNotRemovedIds) {
 	}
 }
 
+TEST(SparseMapTests, Iterator_IterateOverAddedIds_AllAddedIdsIterated) {
+	const aoe::SparseMap<size_t>::Id end = 10;
+	aoe::SparseMap<size_t> sparse_map;
+	std::unordered_set<size_t> expected_ids;
+
+	for (aoe::SparseMap<size_t>::Id id = 0; id < end; ++id) {
+		sparse_map.Add(id, id);
+		expected_ids.insert(id);
+	}
+
+	for (auto [id, value] : sparse_map) {
+		ASSERT_EQ(id, value);
+		expected_ids.erase(id);
+	}
+
+	ASSERT_TRUE(expected_ids.empty());
+}
+
+TEST(SparseMapTests, Sort_SortShuffledAndAlmostSortedData_DataSortedAndIdsPreserved) {
+	const aoe::SparseMap<size_t>::Id end = 1000;
+	aoe::SparseMap<size_t> sparse_map;
+
+	for (aoe::SparseMap<size_t>::Id id = 0; id < end; ++id) {
+		sparse_map.Add(id, (id * 7919) % end);
+	}
+
+	auto compare = [&](size_t lhs, size_t rhs) {
+		return sparse_map.GetByIndex(lhs) < sparse_map.GetByIndex(rhs);
+	};
+
+	sparse_map.Sort(compare);
+	sparse_map.Get(0) = end;
+	sparse_map.Get(end - 1) = end + 1;
+	sparse_map.Sort(compare);
+
+	for (size_t index = 1; index < sparse_map.GetSize(); ++index) {
+		ASSERT_LE(sparse_map.GetByIndex(index - 1), sparse_map.GetByIndex(index));
+	}
+
+	for (aoe::SparseMap<size_t>::Id id = 1; id < end - 1; ++id) {
+		ASSERT_EQ(sparse_map.Get(id), (id * 7919) % end);
+	}
+
+	ASSERT_EQ(sparse_map.GetIds()[end - 2], 0);
+	ASSERT_EQ(sparse_map.GetIds()[end - 1], end - 1);
+}
+
 } // core_tests
 } // aoe_tests
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "pch.h"
+
+#include "../ECS/StableMap.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+TEST(StableMapTests, Get_GetAddedId_AddedId) {
+	aoe::StableMap<size_t> stable_map;
+	const aoe::StableMap<size_t>::Id id = 0;
+	const size_t value = 42;
+
+	stable_map.Add(id, value);
+	size_t result = stable_map.Get(id);
+
+	ASSERT_EQ(result, value);
+}
+
+TEST(StableMapTests, Get_GetRemovedId_Failure) {
+	aoe::StableMap<size_t> stable_map;
+	const aoe::StableMap<size_t>::Id id = 0;
+
+	stable_map.Emplace(id);
+	stable_map.Remove(id);
+
+	ASSERT_DEATH(stable_map.Get(id), "");
+}
+
+TEST(StableMapTests, Get_AddAndRemoveOtherIds_PointersNotChanged) {
+	const size_t ids_count = 5000;
+	aoe::StableMap<size_t> stable_map;
+	std::vector<const size_t*> pointers;
+
+	for (size_t id = 0; id < ids_count; ++id) {
+		stable_map.Add(id, id);
+		pointers.push_back(&stable_map.Get(id));
+	}
+
+	for (size_t id = 0; id < ids_count; id += 2) {
+		stable_map.Remove(id);
+	}
+
+	for (size_t id = ids_count; id < 2 * ids_count; ++id) {
+		stable_map.Add(id, id);
+	}
+
+	for (size_t id = 1; id < ids_count; id += 2) {
+		ASSERT_EQ(&stable_map.Get(id), pointers[id]);
+		ASSERT_EQ(stable_map.Get(id), id);
+	}
+}
+
+TEST(StableMapTests, Iterator_IterateOverAddedIds_AllIdsIterated) {
+	aoe::StableMap<size_t> stable_map;
+
+	for (size_t id = 0; id < 100; ++id) {
+		stable_map.Add(id, id);
+	}
+
+	for (size_t id = 0; id < 100; id += 3) {
+		stable_map.Remove(id);
+	}
+
+	size_t count = 0;
+
+	for (auto [id, value] : stable_map) {
+		ASSERT_EQ(id, value);
+		ASSERT_NE(id % 3, 0);
+		count += 1;
+	}
+
+	ASSERT_EQ(count, stable_map.GetSize());
+}
+
+} // ecs_tests
+} // aoe_tests
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "pch.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../Game/SystemsPool.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+class ExclusiveSystem : public aoe::ECSSystemBase {
+public:
+	ExclusiveSystem()
+		: thread_id()
+	{}
+
+	std::thread::id thread_id;
+
+	void Update(float /*dt*/) override {
+		thread_id = std::this_thread::get_id();
+	}
+};
+
+class ReadingSystem : public aoe::ECSSystemBase {
+public:
+	ReadingSystem()
+		: updates_count(0)
+	{
+		Reads<size_t>();
+	}
+
+	std::atomic<size_t> updates_count;
+
+	// Keeps the workers busy, so the following systems are submitted from them.
+	void Update(float /*dt*/) override {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		updates_count += 1;
+	}
+};
+
+TEST(SystemsPoolTests, Update_UpdateWithThreadPool_ExclusiveSystemsRunOnCallingThread) {
+	aoe::World world;
+	aoe::ThreadPool thread_pool(4);
+	aoe::ServiceProvider service_provider;
+	service_provider.AddService(&world);
+	service_provider.AddService(&thread_pool);
+
+	aoe::SystemsPool systems_pool;
+	ReadingSystem& first = systems_pool.PushSystem<ReadingSystem>();
+	ExclusiveSystem& exclusive = systems_pool.PushSystem<ExclusiveSystem>();
+	ReadingSystem& second = systems_pool.PushSystem<ReadingSystem>();
+	ReadingSystem& third = systems_pool.PushSystem<ReadingSystem>();
+	systems_pool.Initialize(service_provider);
+
+	for (size_t index = 0; index < 10; ++index) {
+		exclusive.thread_id = std::thread::id();
+		systems_pool.Update(0.0f);
+
+		ASSERT_EQ(exclusive.thread_id, std::this_thread::get_id());
+	}
+
+	systems_pool.Terminate();
+
+	ASSERT_EQ(first.updates_count, 10);
+	ASSERT_EQ(second.updates_count, 10);
+	ASSERT_EQ(third.updates_count, 10);
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
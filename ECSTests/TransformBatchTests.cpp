@@ -0,0 +1,143 @@
+#include "pch.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../Game/TransformBatch.h"
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+// Count covers the eight and four lanes paths and the single transforms tail.
+constexpr size_t kTransformsCount = 15;
+constexpr float kTolerance = 1e-4f;
+
+struct TransformColumns {
+	std::vector<float> position_x;
+	std::vector<float> position_y;
+	std::vector<float> position_z;
+	std::vector<float> rotation_x;
+	std::vector<float> rotation_y;
+	std::vector<float> rotation_z;
+	std::vector<float> rotation_w;
+	std::vector<float> scale_x;
+	std::vector<float> scale_y;
+	std::vector<float> scale_z;
+
+	aoe::TransformArrays GetArrays() const {
+		return {
+			position_x.data(), position_y.data(), position_z.data(),
+			rotation_x.data(), rotation_y.data(), rotation_z.data(), rotation_w.data(),
+			scale_x.data(), scale_y.data(), scale_z.data(),
+		};
+	}
+
+	aoe::Affine3x4f GetAffine(size_t index) const {
+		return aoe::Affine3x4f::FromTRS(
+			aoe::Vector3f(position_x[index], position_y[index], position_z[index]),
+			aoe::Quaternion(rotation_w[index], rotation_x[index], rotation_y[index], rotation_z[index]),
+			aoe::Vector3f(scale_x[index], scale_y[index], scale_z[index]));
+	}
+};
+
+TransformColumns CreateTransforms(std::mt19937& random) {
+	std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+	std::uniform_real_distribution<float> scale_distribution(0.5f, 2.0f);
+	TransformColumns columns;
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		float x = distribution(random);
+		float y = distribution(random);
+		float z = distribution(random);
+		float w = distribution(random);
+		float length = std::sqrt(x * x + y * y + z * z + w * w);
+
+		columns.position_x.push_back(distribution(random));
+		columns.position_y.push_back(distribution(random));
+		columns.position_z.push_back(distribution(random));
+		columns.rotation_x.push_back(x / length);
+		columns.rotation_y.push_back(y / length);
+		columns.rotation_z.push_back(z / length);
+		columns.rotation_w.push_back(w / length);
+		columns.scale_x.push_back(scale_distribution(random));
+		columns.scale_y.push_back(scale_distribution(random));
+		columns.scale_z.push_back(scale_distribution(random));
+	}
+
+	return columns;
+}
+
+void AssertAffineNear(const aoe::Affine3x4f& actual, const aoe::Affine3x4f& expected) {
+	for (int row = 0; row < 3; ++row) {
+		for (int column = 0; column < 4; ++column) {
+			ASSERT_NEAR(actual(row, column), expected(row, column), kTolerance);
+		}
+	}
+}
+
+TEST(TransformBatchTests, Compose_ComposeUnparentedAffines_LocalMatricesComposed) {
+	std::mt19937 random(1);
+	TransformColumns columns = CreateTransforms(random);
+	std::vector<aoe::Affine3x4f> globals(kTransformsCount);
+
+	aoe::TransformBatch::Compose(columns.GetArrays(), nullptr, globals.data(), kTransformsCount);
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		AssertAffineNear(globals[index], columns.GetAffine(index));
+	}
+}
+
+TEST(TransformBatchTests, Compose_ComposeParentedAffines_ParentMatricesApplied) {
+	std::mt19937 random(2);
+	TransformColumns columns = CreateTransforms(random);
+	TransformColumns parent_columns = CreateTransforms(random);
+	std::vector<aoe::Affine3x4f> parents;
+	std::vector<aoe::Affine3x4f> globals(kTransformsCount);
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		parents.push_back(parent_columns.GetAffine(index));
+	}
+
+	aoe::TransformBatch::Compose(columns.GetArrays(), parents.data(), globals.data(), kTransformsCount);
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		AssertAffineNear(globals[index], parents[index] * columns.GetAffine(index));
+	}
+}
+
+TEST(TransformBatchTests, Compose_ComposeParentedMatrices_ColumnMajorMatricesComposed) {
+	const size_t matrix_size = 16;
+	std::mt19937 random(3);
+	TransformColumns columns = CreateTransforms(random);
+	TransformColumns parent_columns = CreateTransforms(random);
+	std::vector<float> parents(kTransformsCount * matrix_size);
+	std::vector<float> globals(kTransformsCount * matrix_size);
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		aoe::Affine3x4f parent = parent_columns.GetAffine(index);
+
+		for (int column = 0; column < 4; ++column) {
+			for (int row = 0; row < 4; ++row) {
+				float element = row < 3 ? parent(row, column) : (column == 3 ? 1.0f : 0.0f);
+				parents[index * matrix_size + column * 4 + row] = element;
+			}
+		}
+	}
+
+	aoe::TransformBatch::Compose(columns.GetArrays(), parents.data(), globals.data(), kTransformsCount);
+
+	for (size_t index = 0; index < kTransformsCount; ++index) {
+		aoe::Affine3x4f expected = parent_columns.GetAffine(index) * columns.GetAffine(index);
+
+		for (int column = 0; column < 4; ++column) {
+			for (int row = 0; row < 4; ++row) {
+				float element = row < 3 ? expected(row, column) : (column == 3 ? 1.0f : 0.0f);
+				ASSERT_NEAR(globals[index * matrix_size + column * 4 + row], element, kTolerance);
+			}
+		}
+	}
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "../Reflection/Reflection.h"
+#include "../ECS/WorldSerializer.h"
+
+AOE_REFLECTION_OUTER_BEGIN(int32_t)
+AOE_REFLECTION_OUTER_END()
+
+AOE_REFLECTION_OUTER_BEGIN(float)
+AOE_REFLECTION_OUTER_END()
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+struct SerializedPosition {
+	float x;
+	float y;
+};
+
+class SerializedScale {
+public:
+	int32_t id;
+	float scale;
+
+	SerializedScale()
+		: id(0)
+		, scale(0.0f)
+	{}
+
+	SerializedScale(int32_t id, float scale)
+		: id(id)
+		, scale(scale)
+	{}
+
+	SerializedScale(const SerializedScale& other)
+		: id(other.id)
+		, scale(other.scale)
+	{}
+
+	SerializedScale& operator=(const SerializedScale& other) = default;
+
+	AOE_REFLECTION_BEGIN(SerializedScale)
+	AOE_REFLECTION_FIELD(id)
+	AOE_REFLECTION_FIELD(scale)
+	AOE_REFLECTION_END()
+};
+
+TEST(WorldSerializerTests, Load_LoadSavedWorld_EntitiesAndComponentsLoaded) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "WorldSerializerTests.bin";
+	aoe::WorldSerializer serializer;
+	serializer.Register<SerializedPosition>();
+	serializer.Register<SerializedScale>();
+
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+	world.DestroyEntity(entities.back());
+	world.Validate();
+	entities.pop_back();
+
+	for (aoe::Entity entity : entities) {
+		float value = static_cast<float>(entity.GetId());
+		world.AddComponent<SerializedPosition>(entity, value, -value);
+
+		if (entity.GetId() % 2 == 0) {
+			world.AddComponent<SerializedScale>(entity, entity.GetId(), value * 0.5f);
+		}
+	}
+
+	ASSERT_TRUE(serializer.Save(world, path));
+
+	aoe::World loaded;
+	loaded.AddComponent<size_t>(loaded.CreateEntity(), 0);
+
+	ASSERT_TRUE(serializer.Load(loaded, path));
+	std::filesystem::remove(path);
+
+	for (aoe::Entity entity : entities) {
+		float value = static_cast<float>(entity.GetId());
+		ASSERT_TRUE(loaded.IsEntityValid(entity));
+
+		const auto position = loaded.GetComponent<SerializedPosition>(entity);
+		ASSERT_EQ(position->x, value);
+		ASSERT_EQ(position->y, -value);
+
+		ASSERT_EQ(loaded.HasComponent<SerializedScale>(entity), entity.GetId() % 2 == 0);
+
+		if (entity.GetId() % 2 == 0) {
+			const auto scale = loaded.GetComponent<SerializedScale>(entity);
+			ASSERT_EQ(scale->id, entity.GetId());
+			ASSERT_EQ(scale->scale, value * 0.5f);
+		}
+
+		ASSERT_FALSE(loaded.HasComponent<size_t>(entity));
+	}
+
+	aoe::Entity destroyed(entities.size());
+	ASSERT_FALSE(loaded.IsEntityValid(destroyed));
+	ASSERT_EQ(loaded.CreateEntity().GetId(), entities.size());
+}
+
+// File header takes 48 bytes, block headers take 168 bytes and start with
+// the name, the flag and the element size followed by the count and offsets.
+constexpr uint64_t kEntitiesCountOffset = 16;
+constexpr uint64_t kSecondElementSizeOffset = 48 + 168 + 128 + 4;
+constexpr uint64_t kFirstEntitiesOffset = 48 + 128 + 4 + 4 + 8;
+
+template<typename T>
+T ReadValue(const std::filesystem::path& path, uint64_t offset, T value) {
+	std::ifstream stream(path, std::ios::binary);
+	stream.seekg(offset);
+	stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return value;
+}
+
+template<typename T>
+void WriteValue(const std::filesystem::path& path, uint64_t offset, T value) {
+	std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+	stream.seekp(offset);
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Saves the world, corrupts the file with the function and loads it into
+// the world with a single entity, which must stay as is.
+template<typename TCorrupt>
+void AssertCorruptedFileNotLoaded(TCorrupt corrupt) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "WorldSerializerTests.bin";
+	aoe::WorldSerializer serializer;
+	serializer.Register<SerializedScale>();
+	serializer.Register<SerializedPosition>();
+
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<SerializedScale>(entities, 1, 1.0f);
+	world.AddComponents<SerializedPosition>(entities, 1.0f, 1.0f);
+
+	ASSERT_TRUE(serializer.Save(world, path));
+	corrupt(path);
+
+	aoe::World loaded;
+	aoe::Entity entity = loaded.CreateEntity();
+	loaded.AddComponent<size_t>(entity, 1);
+
+	ASSERT_FALSE(serializer.Load(loaded, path));
+	std::filesystem::remove(path);
+
+	ASSERT_TRUE(loaded.IsEntityValid(entity));
+	ASSERT_EQ(*loaded.GetComponent<size_t>(entity).Get(), 1);
+	ASSERT_FALSE(loaded.HasComponent<SerializedScale>(entity));
+	ASSERT_FALSE(loaded.IsEntityValid(entities.back()));
+}
+
+TEST(WorldSerializerTests, Load_LoadInvalidBlock_WorldNotChanged) {
+	AssertCorruptedFileNotLoaded([](const std::filesystem::path& path) {
+		WriteValue<uint32_t>(path, kSecondElementSizeOffset, 0);
+	});
+}
+
+TEST(WorldSerializerTests, Load_LoadOverflowingEntitiesCount_WorldNotChanged) {
+	AssertCorruptedFileNotLoaded([](const std::filesystem::path& path) {
+		WriteValue<uint64_t>(path, kEntitiesCountOffset, uint64_t(1) << 62);
+	});
+}
+
+TEST(WorldSerializerTests, Load_LoadComponentOfDeadEntity_WorldNotChanged) {
+	AssertCorruptedFileNotLoaded([](const std::filesystem::path& path) {
+		uint64_t offset = ReadValue<uint64_t>(path, kFirstEntitiesOffset, 0);
+		aoe::Entity entity = ReadValue(path, offset, aoe::Entity::Null());
+		WriteValue(path, offset, aoe::Entity(entity.GetVersion() + 1, entity.GetId()));
+	});
+}
+
+} // namespace ecs_tests
+} // namespace aoe_tests
\ No newline at end of file
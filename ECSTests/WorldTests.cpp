@@ -1,8 +1,14 @@
 #include "pch.h"
 
+#include <algorithm>
+#include <random>
+#include <span>
+#include <thread>
 #include <unordered_set>
 
 #include "../ECS/World.h"
+#include "../ECS/WorldView.h"
+#include "../Game/Relationeer.h"
 
 namespace aoe_tests{
 namespace ecs_tests {
@@ -13,6 +19,31 @@ struct TestComponentB {};
 
 struct TestComponentC {};
 
+struct StableComponent {
+	size_t value;
+};
+
+} // ecs_tests
+} // aoe_tests
+
+template<>
+struct aoe::ComponentTraits<aoe_tests::ecs_tests::StableComponent> {
+	static constexpr bool kIsStable = true;
+};
+
+namespace aoe_tests {
+namespace ecs_tests {
+
+struct BatchedEventsCounter {
+	size_t batches_count = 0;
+	size_t entities_count = 0;
+
+	void OnComponentsChanged(std::span<const aoe::Entity> entities) {
+		batches_count += 1;
+		entities_count += entities.size();
+	}
+};
+
 TEST(WorldTests, Add_AddComponentToExistedEntity_EntityHasComponent) {
 	aoe::World world;
 	aoe::Entity entity = world.CreateEntity();
@@ -148,5 +179,757 @@ TEST(WorldTests, Iterator_IterateOverMatchedEntities_AllMatchedEntitiesIterated)
 	ASSERT_TRUE(expected_entities.empty());
 }
 
+TEST(WorldTests, Iterator_IterateOverRareComponent_AllMatchedEntitiesIterated) {
+	size_t entities_count = 100;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::World world;
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<TestComponentA>(entity);
+
+		if (count % 10 == 0) {
+			world.AddComponent<TestComponentB>(entity);
+			expected_entities.insert(entity);
+		}
+	}
+
+	for (aoe::Entity entity : world.FilterEntities<TestComponentA, TestComponentB>()) {
+		ASSERT_TRUE(expected_entities.contains(entity));
+		expected_entities.erase(entity);
+	}
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+TEST(WorldTests, Iterator_RemoveComponentDuringIteration_AllMatchedEntitiesIterated) {
+	size_t entities_count = 10;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::World world;
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<TestComponentA>(entity);
+		expected_entities.insert(entity);
+	}
+
+	for (aoe::Entity entity : world.FilterEntities<TestComponentA>()) {
+		world.RemoveComponent<TestComponentA>(entity);
+		expected_entities.erase(entity);
+	}
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+TEST(WorldTests, ForEach_ModifyIteratedComponents_ComponentsModified) {
+	size_t entities_count = 10;
+	std::vector<aoe::Entity> entities;
+	aoe::World world;
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<size_t>(entity, count);
+		entities.push_back(entity);
+	}
+
+	world.ForEach<size_t>([](aoe::Entity /*entity*/, size_t& value) {
+		value += 1;
+	});
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		auto component = world.GetComponent<size_t>(entities[count]);
+		ASSERT_EQ(*component.Get(), count + 1);
+	}
+}
+
+TEST(WorldTests, View_IterateOverComponents_AllComponentsIterated) {
+	size_t entities_count = 10;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::World world;
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<size_t>(entity, entity.GetId());
+		expected_entities.insert(entity);
+	}
+
+	for (auto [entity, value] : world.ViewComponents<size_t>()) {
+		ASSERT_EQ(value, entity.GetId());
+		expected_entities.erase(entity);
+	}
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+TEST(WorldTests, Iterator_IterateOverArchetypes_AllMatchedEntitiesIterated) {
+	size_t entities_count = 1000;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::World world(aoe::WorldStorage::kArchetype);
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<TestComponentA>(entity);
+
+		if (count % 2 == 0) {
+			world.AddComponent<TestComponentB>(entity);
+			expected_entities.insert(entity);
+		}
+	}
+
+	for (aoe::Entity entity : world.FilterEntities<TestComponentA, TestComponentB>()) {
+		world.RemoveComponent<TestComponentB>(entity);
+		expected_entities.erase(entity);
+	}
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+TEST(WorldTests, View_IterateOverArchetypes_AllComponentsIterated) {
+	size_t entities_count = 1000;
+	std::unordered_set<aoe::Entity> expected_entities;
+	aoe::World world(aoe::WorldStorage::kArchetype);
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<size_t>(entity, entity.GetId());
+		expected_entities.insert(entity);
+
+		if (count % 3 == 0) {
+			world.AddComponent<TestComponentA>(entity);
+		}
+	}
+
+	for (auto [entity, value] : world.ViewComponents<size_t>()) {
+		ASSERT_EQ(value, entity.GetId());
+		expected_entities.erase(entity);
+	}
+
+	ASSERT_TRUE(expected_entities.empty());
+}
+
+TEST(WorldTests, Validate_DestroyEntityWithArchetypes_EntityHasNotComponents) {
+	aoe::World world(aoe::WorldStorage::kArchetype);
+	aoe::Entity entity = world.CreateEntity();
+	aoe::Entity other = world.CreateEntity();
+
+	world.AddComponent<TestComponentA>(entity);
+	world.AddComponent<TestComponentB>(entity);
+	world.AddComponent<TestComponentA>(other);
+	world.DestroyEntity(entity);
+	world.Validate();
+
+	aoe::Entity reused = world.CreateEntity();
+
+	ASSERT_FALSE(world.HasComponent<TestComponentA>(reused));
+	ASSERT_FALSE(world.HasComponent<TestComponentB>(reused));
+	ASSERT_TRUE(world.HasComponent<TestComponentA>(other));
+}
+
+TEST(WorldTests, ParallelForEach_ModifyIteratedComponents_ComponentsModified) {
+	size_t entities_count = 10000;
+	aoe::ThreadPool pool(4);
+	aoe::World world;
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<size_t>(entity, 0);
+		world.AddComponent<TestComponentA>(entity);
+	}
+
+	world.ParallelForEach<size_t, TestComponentA>(pool, [](aoe::Entity entity, size_t& value, TestComponentA& /*component*/) {
+		value = entity.GetId();
+	});
+
+	for (auto [entity, value] : world.ViewComponents<size_t>()) {
+		ASSERT_EQ(value, entity.GetId());
+	}
+}
+
+TEST(WorldTests, ParallelForEach_RemoveComponentDuringIteration_RemovalDeferred) {
+	size_t entities_count = 10000;
+	size_t visited_count = 0;
+	aoe::ThreadPool pool(0);
+	aoe::World world(aoe::WorldStorage::kArchetype);
+
+	for (size_t count = 0; count < entities_count; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<TestComponentA>(entity);
+		world.AddComponent<TestComponentB>(entity);
+	}
+
+	world.ParallelForEach<TestComponentA, TestComponentB>(pool, [&](aoe::Entity entity, TestComponentA& /*a*/, TestComponentB& /*b*/) {
+		world.RemoveComponent<TestComponentB>(entity);
+		ASSERT_TRUE(world.HasComponent<TestComponentB>(entity));
+		visited_count += 1;
+	});
+
+	ASSERT_EQ(visited_count, entities_count);
+	ASSERT_EQ(world.FilterEntities<TestComponentB>().begin(), world.FilterEntities<TestComponentB>().end());
+}
+
+TEST(WorldTests, Filter_FilterChangedComponents_OnlyChangedEntitiesMatched) {
+	aoe::World world;
+	aoe::Entity changed = world.CreateEntity();
+	aoe::Entity unchanged = world.CreateEntity();
+	world.AddComponent<size_t>(changed, 0);
+	world.AddComponent<size_t>(unchanged, 0);
+
+	aoe::ChangeTick since = world.IncrementChangeTick();
+	world.IncrementChangeTick();
+
+	const auto read = world.GetComponent<size_t>(unchanged);
+	ASSERT_EQ(*read.Get(), 0);
+
+	auto write = world.GetComponent<size_t>(changed);
+	*write.Get() = 1;
+
+	std::vector<aoe::Entity> matched;
+
+	for (aoe::Entity entity : world.FilterEntities<aoe::Changed<size_t>>(since)) {
+		matched.push_back(entity);
+	}
+
+	ASSERT_EQ(matched, std::vector<aoe::Entity>{ changed });
+}
+
+TEST(WorldTests, ForEach_ModifyComponentsInGenericFunction_ComponentsChanged) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<int>(entities, 1);
+
+	aoe::ChangeTick since = world.IncrementChangeTick();
+	world.IncrementChangeTick();
+
+	world.ForEach<int>([](aoe::Entity /*entity*/, auto& value) {
+		value += 1;
+	});
+
+	size_t changed_count = 0;
+	world.ForEach<aoe::Changed<int>>([&](aoe::Entity /*entity*/, const int& value) {
+		ASSERT_EQ(value, 2);
+		changed_count += 1;
+	}, since);
+
+	ASSERT_EQ(changed_count, entities.size());
+}
+
+TEST(WorldTests, ForEach_TakeComponentsByConstReference_ComponentsNotChanged) {
+	aoe::World world(aoe::WorldStorage::kArchetype);
+
+	for (size_t count = 0; count < 10; ++count) {
+		aoe::Entity entity = world.CreateEntity();
+		world.AddComponent<size_t>(entity, count);
+		world.AddComponent<TestComponentA>(entity);
+	}
+
+	aoe::ChangeTick since = world.IncrementChangeTick();
+	world.IncrementChangeTick();
+
+	world.ForEach<size_t, TestComponentA>([](aoe::Entity /*entity*/, const size_t& /*value*/, TestComponentA& /*component*/) {});
+
+	size_t changed_count = 0;
+	world.ForEach<aoe::Changed<size_t>>([&](aoe::Entity /*entity*/, const size_t& /*value*/) {
+		changed_count += 1;
+	}, since);
+
+	size_t written_count = 0;
+	world.ForEach<aoe::Changed<TestComponentA>>([&](aoe::Entity /*entity*/, const TestComponentA& /*component*/) {
+		written_count += 1;
+	}, since);
+
+	ASSERT_EQ(changed_count, 0);
+	ASSERT_EQ(written_count, 10);
+}
+
+TEST(WorldTests, AddComponents_AddComponentsToCreatedEntities_SingleEventFired) {
+	const size_t entities_count = 1000;
+	aoe::World world;
+	BatchedEventsCounter counter;
+
+	world.ComponentsAdded<size_t>().Attach(counter, &BatchedEventsCounter::OnComponentsChanged);
+	std::vector<aoe::Entity> entities = world.CreateEntities(entities_count);
+	world.AddComponents<size_t>(entities, 42);
+
+	ASSERT_EQ(counter.batches_count, 1);
+	ASSERT_EQ(counter.entities_count, entities_count);
+
+	for (aoe::Entity entity : entities) {
+		ASSERT_EQ(*world.GetComponent<size_t>(entity).Get(), 42);
+	}
+}
+
+TEST(WorldTests, RemoveComponents_RemovePartOfComponents_OnlyExistedComponentsRemoved) {
+	aoe::World world(aoe::WorldStorage::kArchetype);
+	BatchedEventsCounter counter;
+
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	std::span<const aoe::Entity> first_half(entities.data(), 5);
+	world.AddComponents<TestComponentA>(first_half);
+	world.AddComponents<TestComponentB>(entities);
+
+	world.ComponentsRemoved<TestComponentA>().Attach(counter, &BatchedEventsCounter::OnComponentsChanged);
+	world.RemoveComponents<TestComponentA>(entities);
+
+	ASSERT_EQ(counter.batches_count, 1);
+	ASSERT_EQ(counter.entities_count, first_half.size());
+
+	for (aoe::Entity entity : entities) {
+		ASSERT_FALSE(world.HasComponent<TestComponentA>(entity));
+		ASSERT_TRUE(world.HasComponent<TestComponentB>(entity));
+	}
+}
+
+TEST(WorldTests, GetLastChangeTick_ChangeComponents_LatestTickReturned) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+
+	ASSERT_EQ(world.GetLastChangeTick<size_t>(), 0);
+
+	world.AddComponents<size_t>(entities, 0);
+	aoe::ChangeTick added = world.GetChangeTick();
+	aoe::ChangeTick since = world.IncrementChangeTick();
+
+	world.ForEach<size_t>([](aoe::Entity entity, const size_t& value) {});
+	ASSERT_EQ(world.GetLastChangeTick<size_t>(), added);
+
+	world.ForEach<size_t>([](aoe::Entity entity, size_t& value) {
+		value += 1;
+	});
+
+	ASSERT_EQ(world.GetLastChangeTick<size_t>(), since);
+}
+
+TEST(WorldTests, Get_RemoveOtherStableComponents_PointerNotChanged) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<StableComponent>(entity, static_cast<size_t>(entity.GetId()));
+	}
+
+	aoe::Entity last = entities.back();
+	const StableComponent* pointer = world.GetComponent<StableComponent>(last).Get();
+	entities.pop_back();
+	world.RemoveComponents<StableComponent>(entities);
+
+	ASSERT_EQ(world.GetComponent<StableComponent>(last).Get(), pointer);
+	ASSERT_EQ(pointer->value, last.GetId());
+}
+
+TEST(WorldTests, GetQuery_ChangeComponents_QueryUpdated) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<TestComponentA>(entities);
+
+	for (size_t index = 0; index < entities.size(); index += 2) {
+		world.AddComponent<TestComponentB>(entities[index]);
+	}
+
+	auto& query = world.GetQuery<TestComponentA, TestComponentB>();
+	ASSERT_EQ(query.GetSize(), 5);
+
+	world.RemoveComponent<TestComponentA>(entities[0]);
+	world.AddComponent<TestComponentB>(entities[1]);
+	world.DestroyEntity(entities[2]);
+	world.Validate();
+
+	std::unordered_set<aoe::EntityId> expected = { 1, 4, 6, 8 };
+	std::unordered_set<aoe::EntityId> result;
+
+	for (aoe::Entity entity : world.GetQuery<TestComponentA, TestComponentB>()) {
+		result.insert(entity.GetId());
+	}
+
+	auto& same_query = world.GetQuery<TestComponentA, TestComponentB>();
+	ASSERT_EQ(&same_query, &query);
+	ASSERT_EQ(result, expected);
+}
+
+TEST(WorldTests, GetGroup_ChangeComponents_GroupUpdated) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId()));
+
+		if (entity.GetId() % 3 == 0) {
+			world.AddComponent<TestComponentA>(entity);
+		}
+	}
+
+	auto& group = world.GetGroup<size_t, TestComponentA>();
+	ASSERT_EQ(group.GetSize(), 34);
+
+	world.RemoveComponent<TestComponentA>(entities[0]);
+	world.AddComponent<TestComponentA>(entities[1]);
+	world.RemoveComponent<size_t>(entities[3]);
+
+	std::unordered_set<aoe::EntityId> expected;
+
+	for (aoe::Entity entity : world.FilterEntities<size_t, TestComponentA>()) {
+		expected.insert(entity.GetId());
+	}
+
+	std::unordered_set<aoe::EntityId> result;
+
+	group.ForEach([&](aoe::Entity entity, size_t& value, TestComponentA& component) {
+		ASSERT_EQ(value, entity.GetId());
+		result.insert(entity.GetId());
+		world.RemoveComponent<TestComponentA>(entity);
+	});
+
+	ASSERT_EQ(result, expected);
+	ASSERT_EQ(group.GetSize(), 0);
+}
+
+TEST(WorldTests, Sort_SortAndSortAsPools_PoolsIteratedInOrder) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId() * 37 % 100));
+
+		if (entity.GetId() % 2 == 0) {
+			world.AddComponent<TestComponentA>(entity);
+		}
+	}
+
+	world.Sort<size_t>([](size_t lhs, size_t rhs) {
+		return lhs > rhs;
+	});
+
+	world.SortAs<TestComponentA, size_t>();
+
+	std::vector<size_t> values;
+	std::vector<aoe::Entity> sorted_entities;
+
+	world.ForEach<size_t>([&](aoe::Entity entity, const size_t& value) {
+		values.push_back(value);
+
+		if (world.HasComponent<TestComponentA>(entity)) {
+			sorted_entities.push_back(entity);
+		}
+	});
+
+	ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+
+	std::vector<aoe::Entity> result;
+
+	world.ForEach<TestComponentA>([&](aoe::Entity entity, const TestComponentA& component) {
+		result.push_back(entity);
+	});
+
+	ASSERT_EQ(result, sorted_entities);
+}
+
+TEST(WorldTests, Arrange_ArrangePoolByEntities_DenseStorageFollowsEntities) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId()));
+	}
+
+	std::vector<aoe::Entity> order = entities;
+	std::shuffle(order.begin(), order.end(), std::mt19937(7));
+	order.erase(order.begin() + 50, order.end());
+
+	world.Arrange<size_t>(order);
+
+	std::span<const aoe::Entity> dense_entities = world.GetDenseEntities<size_t>();
+	std::span<size_t> dense_components = world.GetDenseComponents<size_t>();
+
+	ASSERT_EQ(dense_entities.size(), entities.size());
+	ASSERT_TRUE(std::equal(order.begin(), order.end(), dense_entities.begin()));
+
+	for (size_t index = 0; index < dense_entities.size(); ++index) {
+		ASSERT_EQ(dense_components[index], dense_entities[index].GetId());
+	}
+}
+
+TEST(WorldTests, GroupSort_SortGroupByComponent_GroupIteratedInOrder) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId() * 37 % 100));
+		world.AddComponent<TestComponentA>(entity);
+	}
+
+	auto& group = world.GetGroup<size_t, TestComponentA>();
+
+	group.Sort<size_t>([](size_t lhs, size_t rhs) {
+		return lhs > rhs;
+	});
+
+	std::vector<size_t> values;
+
+	group.ForEach([&](aoe::Entity entity, const size_t& value, const TestComponentA& component) {
+		ASSERT_EQ(value, entity.GetId() * 37 % 100);
+		values.push_back(value);
+	});
+
+	ASSERT_EQ(values.size(), entities.size());
+	ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(WorldTests, WorldView_IterateFromThreads_ComponentsWritten) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(1000);
+	world.AddComponents<size_t>(entities, 1);
+	world.AddComponents<TestComponentA>(entities);
+	world.AddComponents<TestComponentB>(entities);
+	aoe::ChangeTick since = world.IncrementChangeTick();
+	world.IncrementChangeTick();
+
+	size_t lhs_sum = 0;
+	size_t rhs_sum = 0;
+
+	std::thread lhs_thread([&]() {
+		aoe::WorldView<aoe::Read<size_t>, aoe::Write<TestComponentA>> view(world);
+
+		view.ForEach<size_t, TestComponentA>([&](aoe::Entity entity, const size_t& value, TestComponentA& component) {
+			lhs_sum += value;
+		});
+	});
+
+	std::thread rhs_thread([&]() {
+		aoe::WorldView<aoe::Read<size_t>, aoe::Write<TestComponentB>> view(world);
+
+		view.ForEach<size_t, TestComponentB>([&](aoe::Entity entity, const size_t& value, TestComponentB& component) {
+			rhs_sum += *view.GetComponent<size_t>(entity);
+		});
+	});
+
+	lhs_thread.join();
+	rhs_thread.join();
+
+	ASSERT_EQ(lhs_sum, entities.size());
+	ASSERT_EQ(rhs_sum, entities.size());
+
+	size_t changed_count = 0;
+
+	for (aoe::Entity entity : world.FilterEntities<aoe::Changed<TestComponentA>, aoe::Changed<TestComponentB>>(since)) {
+		changed_count += 1;
+	}
+
+	for (aoe::Entity entity : world.FilterEntities<aoe::Changed<size_t>>(since)) {
+		changed_count += 1;
+	}
+
+	ASSERT_EQ(changed_count, entities.size());
+}
+
+TEST(WorldTests, Restore_RestoreChangedWorld_SnapshotStateRestored) {
+	aoe::World world;
+	std::vector<aoe::Entity> entities = world.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		world.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId()));
+		world.AddComponent<StableComponent>(entity);
+
+		if (entity.GetId() % 2 == 0) {
+			world.AddComponent<TestComponentA>(entity);
+		}
+	}
+
+	auto& query = world.GetQuery<size_t, TestComponentA>();
+	auto& group = world.GetGroup<size_t, TestComponentA>();
+	aoe::WorldSnapshot snapshot = world.Snapshot();
+
+	world.DestroyEntity(entities[0]);
+	world.RemoveComponent<TestComponentA>(entities[2]);
+	world.AddComponent<TestComponentA>(entities[1]);
+	world.AddComponent<TestComponentB>(world.CreateEntity());
+	*world.GetComponent<size_t>(entities[4]).Get() = 0;
+	world.Validate();
+
+	world.Restore(snapshot);
+
+	for (aoe::Entity entity : entities) {
+		ASSERT_TRUE(world.IsEntityValid(entity));
+		ASSERT_EQ(*world.GetComponent<size_t>(entity).Get(), entity.GetId());
+		ASSERT_TRUE(world.HasComponent<StableComponent>(entity));
+		ASSERT_EQ(world.HasComponent<TestComponentA>(entity), entity.GetId() % 2 == 0);
+		ASSERT_EQ(query.Has(entity), entity.GetId() % 2 == 0);
+		ASSERT_EQ(group.Has(entity), entity.GetId() % 2 == 0);
+	}
+
+	size_t count = 0;
+
+	world.ForEach<TestComponentB>([&](aoe::Entity entity, const TestComponentB& component) {
+		count += 1;
+	});
+
+	ASSERT_EQ(count, 0);
+	ASSERT_EQ(query.GetSize(), entities.size() / 2);
+	ASSERT_EQ(group.GetSize(), entities.size() / 2);
+}
+
+TEST(WorldTests, Restore_RestoreParentedComponents_RelationsResynced) {
+	aoe::World world;
+	aoe::Relationeer<TestComponentA> relationeer(world);
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<TestComponentA>(entities);
+
+	for (size_t index = 1; index < entities.size(); ++index) {
+		relationeer.SetParent(entities[index], entities[index - 1]);
+	}
+
+	aoe::WorldSnapshot snapshot = world.Snapshot();
+
+	aoe::Entity created = world.CreateEntity();
+	world.AddComponent<TestComponentA>(created);
+	relationeer.SetParent(created, entities.back());
+	world.DestroyEntity(entities[0]);
+
+	world.Restore(snapshot);
+
+	ASSERT_FALSE(relationeer.HasRelations(created));
+	ASSERT_EQ(relationeer.GetHierarchy().size(), entities.size());
+	ASSERT_EQ(relationeer.GetLevelsCount(), entities.size());
+	ASSERT_TRUE(relationeer.IsRoot(entities[0]));
+
+	for (size_t index = 1; index < entities.size(); ++index) {
+		ASSERT_EQ(relationeer.GetParent(entities[index]), entities[index - 1]);
+	}
+
+	world.RemoveComponent<TestComponentA>(entities[0]);
+
+	ASSERT_TRUE(relationeer.IsRoot(entities[1]));
+	ASSERT_EQ(relationeer.GetHierarchy().size(), entities.size() - 1);
+}
+
+TEST(WorldTests, Restore_RestoreParentedPair_ParentRestored) {
+	aoe::World world;
+	aoe::Relationeer<TestComponentA> relationeer(world);
+	aoe::Entity parent = world.CreateEntity();
+	aoe::Entity child = world.CreateEntity();
+	world.AddComponent<TestComponentA>(parent);
+	world.AddComponent<TestComponentA>(child);
+	relationeer.SetParent(child, parent);
+
+	aoe::WorldSnapshot snapshot = world.Snapshot();
+	relationeer.MakeRoot(child);
+	world.Restore(snapshot);
+
+	ASSERT_EQ(relationeer.GetParent(child), parent);
+	ASSERT_EQ(*relationeer.GetChildren(parent).begin(), child);
+}
+
+class WorldStorageTests : public testing::TestWithParam<aoe::WorldStorage> {};
+
+TEST_P(WorldStorageTests, Filter_FilterWithoutComponent_EntitiesWithComponentSkipped) {
+	aoe::World world(GetParam());
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<TestComponentA>(entities);
+
+	for (size_t index = 0; index < entities.size(); index += 2) {
+		world.AddComponent<TestComponentB>(entities[index]);
+	}
+
+	std::unordered_set<aoe::EntityId> result;
+
+	for (aoe::Entity entity : world.FilterEntities<TestComponentA, aoe::Without<TestComponentB>>()) {
+		result.insert(entity.GetId());
+	}
+
+	std::unordered_set<aoe::EntityId> expected = { 1, 3, 5, 7, 9 };
+	ASSERT_EQ(result, expected);
+}
+
+TEST_P(WorldStorageTests, ForEach_IterateWithOptionalComponent_MissingComponentIsNull) {
+	aoe::World world(GetParam());
+	std::vector<aoe::Entity> entities = world.CreateEntities(10);
+	world.AddComponents<TestComponentA>(entities);
+
+	for (size_t index = 0; index < entities.size(); index += 2) {
+		world.AddComponent<size_t>(entities[index], index);
+	}
+
+	size_t visited_count = 0;
+
+	world.ForEach<TestComponentA, aoe::Optional<size_t>, aoe::Without<TestComponentC>>(
+		[&](aoe::Entity entity, TestComponentA& component, const size_t* value) {
+			if (entity.GetId() % 2 == 0) {
+				ASSERT_NE(value, nullptr);
+				ASSERT_EQ(*value, entity.GetId());
+			} else {
+				ASSERT_EQ(value, nullptr);
+			}
+
+			visited_count += 1;
+		});
+
+	ASSERT_EQ(visited_count, entities.size());
+}
+
+TEST_P(WorldStorageTests, ParallelForEach_IterateWithoutComponent_EntitiesWithComponentSkipped) {
+	aoe::ThreadPool pool(2);
+	aoe::World world(GetParam());
+	std::vector<aoe::Entity> entities = world.CreateEntities(10000);
+	world.AddComponents<size_t>(entities, 0);
+
+	for (size_t index = 0; index < entities.size(); index += 2) {
+		world.AddComponent<TestComponentB>(entities[index]);
+	}
+
+	world.ParallelForEach<size_t, aoe::Without<TestComponentB>>(pool, [](aoe::Entity entity, size_t& value) {
+		value = 1;
+	}, 0, 100);
+
+	for (aoe::Entity entity : entities) {
+		ASSERT_EQ(*world.GetComponent<size_t>(entity).Get(), entity.GetId() % 2);
+	}
+}
+
+TEST_P(WorldStorageTests, MoveEntities_MoveToAnotherWorld_ComponentsMoved) {
+	aoe::World staging;
+	aoe::World world(GetParam());
+	world.AddComponent<size_t>(world.CreateEntity(), 0);
+
+	std::vector<aoe::Entity> entities = staging.CreateEntities(100);
+
+	for (aoe::Entity entity : entities) {
+		staging.AddComponent<size_t>(entity, static_cast<size_t>(entity.GetId()));
+
+		if (entity.GetId() % 2 == 0) {
+			staging.AddComponent<TestComponentA>(entity);
+		}
+	}
+
+	std::span<const aoe::Entity> to_move(entities.data(), entities.size() / 2);
+	std::vector<aoe::Entity> moved = staging.MoveEntities(to_move, world);
+
+	ASSERT_EQ(moved.size(), to_move.size());
+
+	for (size_t index = 0; index < moved.size(); ++index) {
+		size_t id = static_cast<size_t>(to_move[index].GetId());
+
+		ASSERT_FALSE(staging.IsEntityValid(to_move[index]));
+		ASSERT_TRUE(world.IsEntityValid(moved[index]));
+		ASSERT_EQ(*world.GetComponent<size_t>(moved[index]).Get(), id);
+		ASSERT_EQ(world.HasComponent<TestComponentA>(moved[index]), id % 2 == 0);
+	}
+
+	for (size_t index = to_move.size(); index < entities.size(); ++index) {
+		ASSERT_TRUE(staging.IsEntityValid(entities[index]));
+		ASSERT_EQ(*staging.GetComponent<size_t>(entities[index]).Get(), entities[index].GetId());
+	}
+
+	size_t count = 0;
+
+	world.ForEach<size_t, TestComponentA>([&](aoe::Entity entity, const size_t& value, const TestComponentA& component) {
+		count += 1;
+	});
+
+	ASSERT_EQ(count, to_move.size() / 2);
+}
+
+INSTANTIATE_TEST_CASE_P(
+	WorldTests,
+	WorldStorageTests,
+	testing::Values(aoe::WorldStorage::kSparseSet, aoe::WorldStorage::kArchetype));
+
 } // ecs_tests
 } // aoe_tests
\ No newline at end of file
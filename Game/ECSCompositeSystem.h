@@ -7,13 +7,24 @@ namespace aoe {
 
 class ECSCompositeSystem : public ECSSystemBase {
 public:
+	ECSCompositeSystem()
+		: systems_pool_()
+		, access_(false)
+	{}
+
 	template<typename TSystem, typename...TParams>
 	ECSCompositeSystem& PushSystem(TParams&&... params) {
-		systems_pool_.PushSystem<TSystem>(std::forward<TParams>(params)...);
+		TSystem& system = systems_pool_.PushSystem<TSystem>(std::forward<TParams>(params)...);
+		access_.Merge(system.GetAccess());
 		return *this;
 	}
 
+	const SystemAccess& GetAccess() const override {
+		return access_;
+	}
+
 	void Initialize(const aoe::ServiceProvider& service_provider) override {
+		ECSSystemBase::Initialize(service_provider);
 		systems_pool_.Initialize(service_provider);
 	}
 
@@ -27,6 +38,7 @@ public:
 
 private:
 	SystemsPool systems_pool_;
+	SystemAccess access_;
 };
 
 } // namespace aoe
\ No newline at end of file
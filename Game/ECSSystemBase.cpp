@@ -6,15 +6,38 @@ namespace aoe {
 
 ECSSystemBase::ECSSystemBase()
 	: world_(nullptr)
+	, thread_pool_(nullptr)
+	, access_()
+	, commands_()
+	, last_run_tick_(0)
 {}
 
+ECSSystemBase::~ECSSystemBase() {
+	if (world_ != nullptr) {
+		world_->DetachCommandBuffer(&commands_);
+	}
+}
+
 World* ECSSystemBase::GetWorld() {
 	return world_;
 }
 
+const SystemAccess& ECSSystemBase::GetAccess() const {
+	return access_;
+}
+
+void ECSSystemBase::Tick(float dt) {
+	ChangeTick tick = world_->IncrementChangeTick();
+	Update(dt);
+	last_run_tick_ = tick;
+}
+
 void ECSSystemBase::Initialize(const aoe::ServiceProvider& service_provider) {
 	world_ = service_provider.TryGetService<World>();
 	AOE_ASSERT_MSG(world_ != nullptr, "There is no World service.");
+	world_->AttachCommandBuffer(&commands_);
+
+	thread_pool_ = service_provider.TryGetService<ThreadPool>();
 }
 
 EventBase<Entity>& ECSSystemBase::EntityCreated() {
@@ -25,6 +48,18 @@ EventBase<Entity>& ECSSystemBase::EntityDestroyed() {
 	return world_->EntityDestroyed;
 }
 
+ChangeTick ECSSystemBase::GetLastRunTick() const {
+	return last_run_tick_;
+}
+
+CommandBuffer& ECSSystemBase::GetCommandBuffer() {
+	return commands_;
+}
+
+ThreadPool* ECSSystemBase::GetThreadPool() {
+	return thread_pool_;
+}
+
 bool ECSSystemBase::IsEntityValid(Entity entity) const {
 	return world_->IsEntityValid(entity);
 }
@@ -33,6 +68,10 @@ Entity ECSSystemBase::CreateEntity() {
 	return world_->CreateEntity();
 }
 
+std::vector<Entity> ECSSystemBase::CreateEntities(size_t count) {
+	return world_->CreateEntities(count);
+}
+
 void ECSSystemBase::DestroyEntity(Entity entity) {
 	world_->DestroyEntity(entity);
 }
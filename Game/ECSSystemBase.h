@@ -1,23 +1,37 @@
 #pragma once
 
+#include "../Core/ThreadPool.h"
 #include "../ECS/World.h"
+#include "../ECS/WorldView.h"
 
 #include "ServiceProvider.h"
+#include "SystemAccess.h"
 
 namespace aoe {
 
 class ECSSystemBase {
 public:
 	ECSSystemBase();
-	virtual ~ECSSystemBase() = default;
+	virtual ~ECSSystemBase();
 
 	World* GetWorld();
+	virtual const SystemAccess& GetAccess() const;
 
 	virtual void Initialize(const aoe::ServiceProvider& service_provider);
 	virtual void Terminate() {}
 	virtual void Update(float dt) = 0;
 
+	// Updates the system with the new change tick, so queries of the system
+	// match components changed since its previous update.
+	void Tick(float dt);
+
 protected:
+	template<typename ...TComponents>
+	void Reads();
+
+	template<typename ...TComponents>
+	void Writes();
+
 	EventBase<Entity>& EntityCreated();
 	EventBase<Entity>& EntityDestroyed();
 
@@ -27,8 +41,21 @@ protected:
 	template<typename TComponent>
 	EventBase<Entity>& ComponentRemoved();
 
+	template<typename TComponent>
+	EventBase<std::span<const Entity>>& ComponentsAdded();
+
+	template<typename TComponent>
+	EventBase<std::span<const Entity>>& ComponentsRemoved();
+
+	// Buffer of the system, it's flushed at the world validation.
+	CommandBuffer& GetCommandBuffer();
+
+	// Returns null if there is no ThreadPool service.
+	ThreadPool* GetThreadPool();
+
 	bool IsEntityValid(Entity entity) const;
 	Entity CreateEntity();
+	std::vector<Entity> CreateEntities(size_t count);
 	void DestroyEntity(Entity entity);
 
 	template<typename TComponent>
@@ -37,19 +64,65 @@ protected:
 	template<typename TComponent, typename ...TArgs>
 	void AddComponent(Entity entity, TArgs&&... args);
 
+	template<typename TComponent, typename ...TArgs>
+	void AddComponents(std::span<const Entity> entities, const TArgs&... args);
+
 	template<typename TComponent>
 	CH<TComponent> GetComponent(Entity entity);
 
 	template<typename TComponent>
 	void RemoveComponent(Entity entity);
 
-	template <typename ...TComponents>
+	template<typename TComponent>
+	void RemoveComponents(std::span<const Entity> entities);
+
+	template<typename TComponent, typename TCompare>
+	void Sort(TCompare compare);
+
+	template<typename TComponent, typename TOther>
+	void SortAs();
+
+	ChangeTick GetLastRunTick() const;
+
+	template <typename ...TTerms>
 	auto FilterEntities();
 
+	template<typename TComponent>
+	auto ViewComponents();
+
+	template<typename ...TComponents>
+	Query<TComponents...>& GetQuery();
+
+	template<typename ...TComponents>
+	Group<TComponents...>& GetGroup();
+
+	template<typename ...TAccesses>
+	WorldView<TAccesses...> GetView();
+
+	template <typename ...TTerms, typename TFunction>
+	void ForEach(TFunction function);
+
+	template <typename ...TTerms, typename TFunction>
+	void ParallelForEach(TFunction function);
+
 private:
 	World* world_;
+	ThreadPool* thread_pool_;
+	SystemAccess access_;
+	CommandBuffer commands_;
+	ChangeTick last_run_tick_;
 };
 
+template<typename ...TComponents>
+void ECSSystemBase::Reads() {
+	access_.AddReads<TComponents...>();
+}
+
+template<typename ...TComponents>
+void ECSSystemBase::Writes() {
+	access_.AddWrites<TComponents...>();
+}
+
 template<typename TComponent>
 EventBase<Entity>& ECSSystemBase::ComponentAdded() {
 	return world_->ComponentAdded<TComponent>();
@@ -60,6 +133,16 @@ EventBase<Entity>& ECSSystemBase::ComponentRemoved() {
 	return world_->ComponentRemoved<TComponent>();
 }
 
+template<typename TComponent>
+EventBase<std::span<const Entity>>& ECSSystemBase::ComponentsAdded() {
+	return world_->ComponentsAdded<TComponent>();
+}
+
+template<typename TComponent>
+EventBase<std::span<const Entity>>& ECSSystemBase::ComponentsRemoved() {
+	return world_->ComponentsRemoved<TComponent>();
+}
+
 template<typename TComponent>
 bool ECSSystemBase::HasComponent(Entity entity) const {
 	return world_->HasComponent<TComponent>(entity);
@@ -70,6 +153,11 @@ void ECSSystemBase::AddComponent(Entity entity, TArgs&&... args) {
 	world_->AddComponent<TComponent>(entity, std::forward<TArgs>(args)...);
 }
 
+template<typename TComponent, typename ...TArgs>
+void ECSSystemBase::AddComponents(std::span<const Entity> entities, const TArgs&... args) {
+	world_->AddComponents<TComponent>(entities, args...);
+}
+
 template<typename TComponent>
 CH<TComponent> ECSSystemBase::GetComponent(Entity entity) {
 	return world_->GetComponent<TComponent>(entity);
@@ -80,9 +168,58 @@ void ECSSystemBase::RemoveComponent(Entity entity) {
 	world_->RemoveComponent<TComponent>(entity);
 }
 
-template <typename ...TComponents>
+template<typename TComponent>
+void ECSSystemBase::RemoveComponents(std::span<const Entity> entities) {
+	world_->RemoveComponents<TComponent>(entities);
+}
+
+template<typename TComponent, typename TCompare>
+void ECSSystemBase::Sort(TCompare compare) {
+	world_->Sort<TComponent>(compare);
+}
+
+template<typename TComponent, typename TOther>
+void ECSSystemBase::SortAs() {
+	world_->SortAs<TComponent, TOther>();
+}
+
+template <typename ...TTerms>
 auto ECSSystemBase::FilterEntities() {
-	return world_->FilterEntities<TComponents...>();
+	return world_->FilterEntities<TTerms...>(last_run_tick_);
+}
+
+template<typename TComponent>
+auto ECSSystemBase::ViewComponents() {
+	return world_->ViewComponents<TComponent>();
+}
+
+template<typename ...TComponents>
+Query<TComponents...>& ECSSystemBase::GetQuery() {
+	return world_->GetQuery<TComponents...>();
+}
+
+template<typename ...TComponents>
+Group<TComponents...>& ECSSystemBase::GetGroup() {
+	return world_->GetGroup<TComponents...>();
+}
+
+template<typename ...TAccesses>
+WorldView<TAccesses...> ECSSystemBase::GetView() {
+	return WorldView<TAccesses...>(*world_, last_run_tick_);
+}
+
+template <typename ...TTerms, typename TFunction>
+void ECSSystemBase::ForEach(TFunction function) {
+	world_->ForEach<TTerms...>(function, last_run_tick_);
+}
+
+template <typename ...TTerms, typename TFunction>
+void ECSSystemBase::ParallelForEach(TFunction function) {
+	if (thread_pool_ != nullptr) {
+		world_->ParallelForEach<TTerms...>(*thread_pool_, function, last_run_tick_);
+	} else {
+		world_->ForEach<TTerms...>(function, last_run_tick_);
+	}
 }
 
 } // namespace aoe
\ No newline at end of file
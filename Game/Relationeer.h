@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "../ECS/World.h"
 
 namespace aoe {
@@ -7,14 +13,103 @@ namespace aoe {
 template<typename TComponent>
 class Relationeer {
 public:
+	static constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+
+	// Parent index refers to the node of the previous level.
+	struct HierarchyNode {
+		Entity entity;
+		size_t parent_index;
+	};
+
+	// Iterates the children through the sibling links.
+	class Children {
+	public:
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = Entity;
+			using pointer = const Entity*;
+			using reference = const Entity&;
+
+			Iterator(const Relationeer* relationeer, Entity entity)
+				: relationeer_(relationeer)
+				, entity_(entity)
+			{}
+
+			reference operator*() const {
+				return entity_;
+			}
+
+			Iterator& operator++() {
+				entity_ = relationeer_->GetRelations(entity_).next_sibling;
+				return *this;
+			}
+
+			Iterator operator++(int) {
+				Iterator temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			friend bool operator== (const Iterator& lhs, const Iterator& rhs) {
+				return lhs.entity_ == rhs.entity_;
+			}
+
+			friend bool operator!= (const Iterator& lhs, const Iterator& rhs) {
+				return !(lhs == rhs);
+			}
+
+		private:
+			const Relationeer* relationeer_;
+			Entity entity_;
+		};
+
+		Children(const Relationeer* relationeer, Entity first_child)
+			: relationeer_(relationeer)
+			, first_child_(first_child)
+		{}
+
+		Iterator begin() const {
+			return { relationeer_, first_child_ };
+		}
+
+		Iterator end() const {
+			return { relationeer_, Entity::Null() };
+		}
+
+	private:
+		const Relationeer* relationeer_;
+		Entity first_child_;
+	};
+
+	// Mirrors the parent link into the world, so world snapshots capture
+	// the parenting and it's linked back on restore.
+	struct Parent {
+		Entity entity;
+
+		Parent(Entity entity)
+			: entity(entity)
+		{}
+	};
+
+	// Notifies when the entity is attached to or detached from the parent.
+	Event<Relationeer, Entity> ParentChanged;
+
 	Relationeer(aoe::World& world)
 		: world_(world)
 		, relations_()
+		, hierarchy_()
+		, level_offsets_()
+		, is_hierarchy_dirty_(true)
+		, sync_tick_(0)
 	{
 		world_.ComponentAdded<TComponent>().Attach(
 			*this, &Relationeer<TComponent>::OnComponentAdded);
 		world_.ComponentRemoved<TComponent>().Attach(
 			*this, &Relationeer<TComponent>::OnComponentRemoved);
+		world_.Restored.Attach(
+			*this, &Relationeer<TComponent>::OnWorldRestored);
 	}
 
 	~Relationeer() {
@@ -22,6 +117,8 @@ public:
 			*this, &Relationeer<TComponent>::OnComponentAdded);
 		world_.ComponentRemoved<TComponent>().Detach(
 			*this, &Relationeer<TComponent>::OnComponentRemoved);
+		world_.Restored.Detach(
+			*this, &Relationeer<TComponent>::OnWorldRestored);
 	}
 
 	bool HasRelations(Entity entity) const {
@@ -44,31 +141,61 @@ public:
 		AOE_ASSERT_MSG(child.GetId() != parent.GetId(), "Entity can't be parent for itself.");
 		AOE_ASSERT_MSG(!IsChildOf(parent, child), "Parent doesn't have to be a child.");
 
-		MakeRoot(child);
-		child_relations.parent = parent;
-		parent_relations.children.push_back(child);
+		Unlink(child_relations);
+		Link(child_relations, parent_relations);
+		world_.AddComponent<Parent>(child, parent);
+		ParentChanged.Notify(child);
 	}
 
 	void MakeRoot(Entity child) {
 		Relations& child_relations = GetRelations(child);
-		Entity parent = child_relations.parent;
 
-		if (parent.IsNull()) {
+		if (child_relations.parent.IsNull()) {
 			return;
 		}
 
-		child_relations.parent = Entity::Null();
+		Unlink(child_relations);
+		world_.RemoveComponent<Parent>(child);
+		is_hierarchy_dirty_ = true;
+		ParentChanged.Notify(child);
+	}
 
-		Relations& parent_relations = GetRelations(parent);
-		std::vector<Entity>& parent_children = parent_relations.children;
+	// Children go in reverse order of attaching.
+	Children GetChildren(Entity entity) const {
+		const Relations& relations = GetRelations(entity);
+		return { this, relations.first_child };
+	}
 
-		auto it = std::remove(parent_children.begin(), parent_children.end(), child);
-		parent_children.erase(it, parent_children.end());
+	// Nodes ordered by levels, so parents precede their children. Nodes of
+	// the same level are independent of each other.
+	const std::vector<HierarchyNode>& GetHierarchy() {
+		UpdateHierarchy();
+		return hierarchy_;
 	}
 
-	const std::vector<Entity>& GetChildren(Entity entity) const {
-		const Relations& relations = GetRelations(entity);
-		return relations.children;
+	size_t GetLevelsCount() {
+		UpdateHierarchy();
+		return level_offsets_.size() - 1;
+	}
+
+	size_t GetLevelBegin(size_t level) {
+		UpdateHierarchy();
+		return level_offsets_[level];
+	}
+
+	size_t GetLevelEnd(size_t level) {
+		UpdateHierarchy();
+		return level_offsets_[level + 1];
+	}
+
+	// Systems which derive the components state from the hierarchy, like
+	// TransformSystem, store the tick the state is up to date at.
+	ChangeTick GetSyncTick() const {
+		return sync_tick_;
+	}
+
+	void SetSyncTick(ChangeTick tick) {
+		sync_tick_ = tick;
 	}
 
 	bool IsRoot(Entity entity) const {
@@ -92,18 +219,29 @@ public:
 	}
 
 private:
+	// Children of the entity are linked into the list through siblings.
 	struct Relations {
+		Entity entity;
 		Entity parent;
-		std::vector<Entity> children;
-
-		Relations()
-			: parent(Entity::Null())
-			, children()
+		Entity first_child;
+		Entity prev_sibling;
+		Entity next_sibling;
+
+		Relations(Entity entity)
+			: entity(entity)
+			, parent(Entity::Null())
+			, first_child(Entity::Null())
+			, prev_sibling(Entity::Null())
+			, next_sibling(Entity::Null())
 		{}
 	};
 
 	World& world_;
 	SparseMap<Relations> relations_;
+	std::vector<HierarchyNode> hierarchy_;
+	std::vector<size_t> level_offsets_;
+	bool is_hierarchy_dirty_;
+	ChangeTick sync_tick_;
 
 	void AssertHasRelations(Entity entity) const {
 		AOE_ASSERT_MSG(HasRelations(entity), "Entity hasn't relations.");
@@ -118,11 +256,44 @@ private:
 	}
 
 	void AddRelations(Entity entity) {
-		relations_.Emplace(entity.GetId());
+		relations_.Emplace(entity.GetId(), entity);
+		is_hierarchy_dirty_ = true;
 	}
 
 	void RemoveRelations(Entity entity) {
 		relations_.Remove(entity.GetId());
+		is_hierarchy_dirty_ = true;
+	}
+
+	// Breadth first from the roots, each level is appended after the previous one.
+	void UpdateHierarchy() {
+		if (!is_hierarchy_dirty_) {
+			return;
+		}
+
+		hierarchy_.clear();
+		level_offsets_.assign(1, 0);
+
+		for (const Relations& relations : relations_.GetData()) {
+			if (relations.parent.IsNull()) {
+				hierarchy_.push_back({ relations.entity, kNoParent });
+			}
+		}
+
+		for (size_t begin = 0; begin < hierarchy_.size();) {
+			size_t end = hierarchy_.size();
+
+			for (size_t index = begin; index < end; ++index) {
+				for (Entity child : GetChildren(hierarchy_[index].entity)) {
+					hierarchy_.push_back({ child, index });
+				}
+			}
+
+			level_offsets_.push_back(end);
+			begin = end;
+		}
+
+		is_hierarchy_dirty_ = false;
 	}
 
 	void OnComponentAdded(Entity entity) {
@@ -134,16 +305,83 @@ private:
 		RemoveRelations(entity);
 	}
 
+	// The links are rebuilt from the restored parent components.
+	void OnWorldRestored() {
+		relations_.Clear();
+		is_hierarchy_dirty_ = true;
+		sync_tick_ = 0;
+
+		for (Entity entity : world_.FilterEntities<TComponent>()) {
+			AddRelations(entity);
+		}
+
+		for (Entity entity : world_.FilterEntities<TComponent, Parent>()) {
+			CH<Parent> component = world_.GetComponent<Parent>(entity);
+			Entity parent = std::as_const(component)->entity;
+
+			if (world_.IsEntityValid(parent) && HasRelations(parent)) {
+				Link(GetRelations(entity), GetRelations(parent));
+			}
+		}
+
+		for (const Relations& relations : relations_.GetData()) {
+			ParentChanged.Notify(relations.entity);
+		}
+	}
+
 	void BreakHierarchy(Entity entity) {
 		MakeRoot(entity);
 		Relations& relations = GetRelations(entity);
 
-		for (Entity child : relations.children) {
+		for (Entity child = relations.first_child; !child.IsNull();) {
 			Relations& child_relations = GetRelations(child);
+			Entity next_sibling = child_relations.next_sibling;
+
 			child_relations.parent = Entity::Null();
+			child_relations.prev_sibling = Entity::Null();
+			child_relations.next_sibling = Entity::Null();
+			world_.RemoveComponent<Parent>(child);
+			ParentChanged.Notify(child);
+
+			child = next_sibling;
+		}
+
+		relations.first_child = Entity::Null();
+		is_hierarchy_dirty_ = true;
+	}
+
+	// Prepends the child to the children of the parent.
+	void Link(Relations& child_relations, Relations& parent_relations) {
+		child_relations.parent = parent_relations.entity;
+		child_relations.next_sibling = parent_relations.first_child;
+
+		if (!parent_relations.first_child.IsNull()) {
+			GetRelations(parent_relations.first_child).prev_sibling = child_relations.entity;
+		}
+
+		parent_relations.first_child = child_relations.entity;
+		is_hierarchy_dirty_ = true;
+	}
+
+	// Detaches the entity from the parent and the siblings.
+	void Unlink(Relations& relations) {
+		if (relations.parent.IsNull()) {
+			return;
+		}
+
+		if (relations.prev_sibling.IsNull()) {
+			GetRelations(relations.parent).first_child = relations.next_sibling;
+		} else {
+			GetRelations(relations.prev_sibling).next_sibling = relations.next_sibling;
+		}
+
+		if (!relations.next_sibling.IsNull()) {
+			GetRelations(relations.next_sibling).prev_sibling = relations.prev_sibling;
 		}
 
-		relations.children.clear();
+		relations.parent = Entity::Null();
+		relations.prev_sibling = Entity::Null();
+		relations.next_sibling = Entity::Null();
 	}
 };
 
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../Core/Identifier.h"
+
+namespace aoe {
+
+// Components which a system reads and writes. Exclusive systems never run
+// concurrently with other systems and run on the updating thread. A
+// system which declares its access must not create or destroy entities
+// and must not add or remove components, since the world isn't
+// synchronized.
+class SystemAccess {
+public:
+	SystemAccess()
+		: SystemAccess(true)
+	{}
+
+	SystemAccess(bool is_exclusive)
+		: reads_()
+		, writes_()
+		, is_exclusive_(is_exclusive)
+	{}
+
+	bool IsExclusive() const {
+		return is_exclusive_;
+	}
+
+	template<typename ...TComponents>
+	void AddReads() {
+		(Add(reads_, GetTypeId<TComponents>()), ...);
+		is_exclusive_ = false;
+	}
+
+	template<typename ...TComponents>
+	void AddWrites() {
+		(Add(writes_, GetTypeId<TComponents>()), ...);
+		is_exclusive_ = false;
+	}
+
+	void Merge(const SystemAccess& other) {
+		for (TypeId type_id : other.reads_) {
+			Add(reads_, type_id);
+		}
+
+		for (TypeId type_id : other.writes_) {
+			Add(writes_, type_id);
+		}
+
+		is_exclusive_ = is_exclusive_ || other.is_exclusive_;
+	}
+
+	bool IsConflicting(const SystemAccess& other) const {
+		if (is_exclusive_ || other.is_exclusive_) {
+			return true;
+		}
+
+		return HasAny(writes_, other.writes_)
+			|| HasAny(writes_, other.reads_)
+			|| HasAny(reads_, other.writes_);
+	}
+
+private:
+	class ComponentIdentifier : public IdentifierBase<ComponentIdentifier> {};
+
+	std::vector<TypeId> reads_;
+	std::vector<TypeId> writes_;
+	bool is_exclusive_;
+
+	template<typename TComponent>
+	static TypeId GetTypeId() {
+		return ComponentIdentifier::GetTypeId<TComponent>();
+	}
+
+	static void Add(std::vector<TypeId>& type_ids, TypeId type_id) {
+		if (std::find(type_ids.begin(), type_ids.end(), type_id) == type_ids.end()) {
+			type_ids.push_back(type_id);
+		}
+	}
+
+	static bool HasAny(const std::vector<TypeId>& lhs, const std::vector<TypeId>& rhs) {
+		for (TypeId type_id : lhs) {
+			if (std::find(rhs.begin(), rhs.end(), type_id) != rhs.end()) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "ECSSystemBase.h"
+#include "SystemsScheduler.h"
 
 namespace aoe {
 
@@ -14,6 +15,8 @@ AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(SystemsPool)
 public:
 	SystemsPool()
 		: systems_()
+		, scheduler_()
+		, thread_pool_(nullptr)
 		, is_inited_(false)
 	{}
 
@@ -42,6 +45,8 @@ public:
 			system->Initialize(service_provider);
 		}
 
+		scheduler_.Build(systems_);
+		thread_pool_ = service_provider.TryGetService<ThreadPool>();
 		is_inited_ = true;
 	}
 
@@ -58,13 +63,24 @@ public:
 	void Update(float dt) {
 		AOE_ASSERT_MSG(is_inited_, "Systems is not inited.");
 
+		if (thread_pool_ != nullptr) {
+			scheduler_.Update(*thread_pool_, dt);
+			return;
+		}
+
 		for (ECSSystemBase* system : systems_) {
-			system->Update(dt);
+			system->Tick(dt);
 		}
 	}
 
+	const SystemsScheduler& GetScheduler() const {
+		return scheduler_;
+	}
+
 private:
 	std::vector<ECSSystemBase*> systems_;
+	SystemsScheduler scheduler_;
+	ThreadPool* thread_pool_;
 	bool is_inited_;
 };
 
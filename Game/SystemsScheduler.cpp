@@ -0,0 +1,206 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <typeinfo>
+
+#include "SystemsScheduler.h"
+
+namespace aoe {
+
+SystemsScheduler::SystemsScheduler()
+	: nodes_()
+	, dependencies_()
+{}
+
+void SystemsScheduler::Build(const std::vector<ECSSystemBase*>& systems) {
+	nodes_.clear();
+
+	for (ECSSystemBase* system : systems) {
+		nodes_.push_back({ system, {}, {}, 0.0 });
+	}
+
+	// Systems are visited from the closest one, so edges implied by
+	// already added ones are skipped.
+	std::vector<std::vector<bool>> ancestors(nodes_.size(), std::vector<bool>(nodes_.size(), false));
+
+	for (size_t current = 0; current < nodes_.size(); ++current) {
+		const SystemAccess& access = nodes_[current].system->GetAccess();
+
+		for (size_t previous = current; previous > 0; --previous) {
+			size_t candidate = previous - 1;
+
+			if (ancestors[current][candidate]) {
+				continue;
+			}
+
+			if (!access.IsConflicting(nodes_[candidate].system->GetAccess())) {
+				continue;
+			}
+
+			nodes_[current].predecessors.push_back(candidate);
+			nodes_[candidate].successors.push_back(current);
+			ancestors[current][candidate] = true;
+
+			for (size_t index = 0; index < candidate; ++index) {
+				if (ancestors[candidate][index]) {
+					ancestors[current][index] = true;
+				}
+			}
+		}
+	}
+
+	dependencies_ = std::vector<std::atomic<size_t>>(nodes_.size());
+}
+
+// Exclusive system conflicts with all others, so the systems pushed
+// before it are finished and the ones pushed after it wait for it.
+void SystemsScheduler::Update(ThreadPool& pool, float dt) {
+	size_t begin = 0;
+
+	while (begin < nodes_.size()) {
+		size_t end = begin;
+
+		while (end < nodes_.size() && !IsExclusive(end)) {
+			++end;
+		}
+
+		RunSegment(pool, dt, begin, end);
+
+		if (end < nodes_.size()) {
+			Tick(dt, end);
+		}
+
+		begin = end + 1;
+	}
+}
+
+std::vector<ECSSystemBase*> SystemsScheduler::GetCriticalPath() const {
+	std::vector<ECSSystemBase*> path;
+
+	for (size_t index : GetCriticalPathIndices()) {
+		path.push_back(nodes_[index].system);
+	}
+
+	return path;
+}
+
+void SystemsScheduler::DumpGraph(std::ostream& stream) const {
+	std::vector<size_t> critical_path = GetCriticalPathIndices();
+
+	stream << "digraph Systems {" << std::endl;
+
+	for (size_t index = 0; index < nodes_.size(); ++index) {
+		const Node& node = nodes_[index];
+		bool is_critical = std::find(critical_path.begin(), critical_path.end(), index) != critical_path.end();
+
+		stream << "\t" << index
+			<< " [label=\"" << typeid(*node.system).name() << "\\n" << node.duration << " ms\""
+			<< (is_critical ? ", color=red" : "")
+			<< "];" << std::endl;
+	}
+
+	for (size_t index = 0; index < nodes_.size(); ++index) {
+		for (size_t successor : nodes_[index].successors) {
+			stream << "\t" << index << " -> " << successor << ";" << std::endl;
+		}
+	}
+
+	stream << "}" << std::endl;
+}
+
+bool SystemsScheduler::IsExclusive(size_t index) const {
+	return nodes_[index].system->GetAccess().IsExclusive();
+}
+
+// Predecessors outside of the segment are already finished.
+void SystemsScheduler::RunSegment(ThreadPool& pool, float dt, size_t begin, size_t end) {
+	if (begin == end) {
+		return;
+	}
+
+	std::atomic<size_t> pending = end - begin;
+
+	for (size_t index = begin; index < end; ++index) {
+		const std::vector<size_t>& predecessors = nodes_[index].predecessors;
+
+		dependencies_[index] = std::count_if(predecessors.begin(), predecessors.end(), [begin](size_t predecessor) {
+			return predecessor >= begin;
+		});
+	}
+
+	for (size_t index = begin; index < end; ++index) {
+		if (dependencies_[index] == 0) {
+			pool.Submit([this, &pool, &pending, dt, index]() {
+				Run(pool, pending, dt, index);
+			});
+		}
+	}
+
+	pool.Wait(pending);
+}
+
+void SystemsScheduler::Run(ThreadPool& pool, std::atomic<size_t>& pending, float dt, size_t index) {
+	Tick(dt, index);
+
+	// The only successor outside of the segment is the exclusive system
+	// which ends it.
+	for (size_t successor : nodes_[index].successors) {
+		if (IsExclusive(successor)) {
+			continue;
+		}
+
+		if (dependencies_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pool.Submit([this, &pool, &pending, dt, successor]() {
+				Run(pool, pending, dt, successor);
+			});
+		}
+	}
+
+	pending.fetch_sub(1, std::memory_order_release);
+}
+
+void SystemsScheduler::Tick(float dt, size_t index) {
+	Node& node = nodes_[index];
+
+	auto start = std::chrono::steady_clock::now();
+	node.system->Tick(dt);
+	node.duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<size_t> SystemsScheduler::GetCriticalPathIndices() const {
+	if (nodes_.empty()) {
+		return {};
+	}
+
+	// Nodes are already in the topological order.
+	std::vector<double> lengths(nodes_.size(), 0.0);
+	std::vector<size_t> previous(nodes_.size(), nodes_.size());
+	size_t last = 0;
+
+	for (size_t index = 0; index < nodes_.size(); ++index) {
+		for (size_t predecessor : nodes_[index].predecessors) {
+			if (lengths[predecessor] > lengths[index] || previous[index] == nodes_.size()) {
+				lengths[index] = lengths[predecessor];
+				previous[index] = predecessor;
+			}
+		}
+
+		lengths[index] += nodes_[index].duration;
+
+		if (lengths[index] > lengths[last]) {
+			last = index;
+		}
+	}
+
+	std::vector<size_t> path;
+
+	for (size_t index = last; index != nodes_.size(); index = previous[index]) {
+		path.push_back(index);
+	}
+
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+} // namespace aoe
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+#include "../Core/ClassHelper.h"
+#include "../Core/ThreadPool.h"
+
+#include "ECSSystemBase.h"
+
+namespace aoe {
+
+// Runs systems as a dependency graph. System depends on the closest
+// previously pushed systems whose access conflicts with its own, so
+// conflicting systems keep the push order and the others run concurrently.
+// Exclusive systems, like the render passes, run on the calling thread
+// between the parallel segments, since they may use thread affine devices.
+class SystemsScheduler {
+AOE_NON_COPYABLE_AND_NON_MOVABLE_CLASS(SystemsScheduler)
+
+public:
+	SystemsScheduler();
+
+	void Build(const std::vector<ECSSystemBase*>& systems);
+	void Update(ThreadPool& pool, float dt);
+
+	// Longest chain of dependent systems by the last update durations.
+	std::vector<ECSSystemBase*> GetCriticalPath() const;
+
+	// Writes the graph in the DOT format, critical path is highlighted.
+	void DumpGraph(std::ostream& stream) const;
+
+private:
+	struct Node {
+		ECSSystemBase* system;
+		std::vector<size_t> predecessors;
+		std::vector<size_t> successors;
+		double duration;
+	};
+
+	std::vector<Node> nodes_;
+	std::vector<std::atomic<size_t>> dependencies_;
+
+	bool IsExclusive(size_t index) const;
+	void RunSegment(ThreadPool& pool, float dt, size_t begin, size_t end);
+	void Run(ThreadPool& pool, std::atomic<size_t>& pending, float dt, size_t index);
+	void Tick(float dt, size_t index);
+	std::vector<size_t> GetCriticalPathIndices() const;
+};
+
+} // namespace aoe
\ No newline at end of file
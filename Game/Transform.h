@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../Core/Affine3x4f.h"
 #include "../Core/Math.h"
 
 namespace aoe {
@@ -35,6 +36,10 @@ struct Transform {
 		return world_matrix;
 	}
 
+	Affine3x4f ToAffine() const {
+		return Affine3x4f::FromTRS(position, rotation, scale);
+	}
+
 	Vector3f GetRight() const {
 		return rotation * Math::kRight;
 	}
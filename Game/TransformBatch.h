@@ -0,0 +1,485 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "../Core/Affine3x4f.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define AOE_TRANSFORM_BATCH_SSE
+
+	#include <immintrin.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP
+
+#if defined(AOE_TRANSFORM_BATCH_SSE) && defined(__AVX2__)
+	#define AOE_TRANSFORM_BATCH_AVX2
+#endif // AOE_TRANSFORM_BATCH_SSE && __AVX2__
+
+// MSVC allows FMA with AVX2, other compilers define it separately.
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+	#define AOE_TRANSFORM_BATCH_FMA
+#endif // __FMA__ || _MSC_VER && __AVX2__
+
+namespace aoe {
+
+// Local transforms as structure of arrays, rotations are unit quaternions.
+struct TransformArrays {
+	const float* position_x;
+	const float* position_y;
+	const float* position_z;
+	const float* rotation_x;
+	const float* rotation_y;
+	const float* rotation_z;
+	const float* rotation_w;
+	const float* scale_x;
+	const float* scale_y;
+	const float* scale_z;
+};
+
+// Composes translation * rotation * scale of many transforms at once without
+// generic matrix multiplications. Matrices are either column major 4x4 ones,
+// 16 floats each, or Affine3x4f ones.
+class TransformBatch {
+public:
+	TransformBatch() = delete;
+
+	// Writes parent * local matrices. Parents must be affine, null parents
+	// mean local matrices are written as is.
+	static void Compose(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t count)
+	{
+		size_t index = 0;
+
+#ifdef AOE_TRANSFORM_BATCH_SSE
+		for (; index + kLanes <= count; index += kLanes) {
+			ComposeLanes(transforms, parent_matrices, global_matrices, index);
+		}
+#endif // AOE_TRANSFORM_BATCH_SSE
+
+		for (; index < count; ++index) {
+			ComposeSingle(transforms, parent_matrices, global_matrices, index);
+		}
+	}
+
+	// Same as Compose, but matrices are stored as Affine3x4f rows, so the
+	// implicit last row is neither read nor written. Eight transforms are
+	// composed at once with AVX2, the tail goes by four and then one by one.
+	static void Compose(
+		const TransformArrays& transforms,
+		const Affine3x4f* parent_matrices,
+		Affine3x4f* global_matrices,
+		size_t count)
+	{
+		static_assert(sizeof(Affine3x4f) == kAffineSize * sizeof(float), "Affine matrix isn't tightly packed.");
+
+		const float* parents = reinterpret_cast<const float*>(parent_matrices);
+		float* globals = reinterpret_cast<float*>(global_matrices);
+		size_t index = 0;
+
+#ifdef AOE_TRANSFORM_BATCH_AVX2
+		for (; index + kWideLanes <= count; index += kWideLanes) {
+			ComposeAffineWideLanes(transforms, parents, globals, index);
+		}
+#endif // AOE_TRANSFORM_BATCH_AVX2
+
+#ifdef AOE_TRANSFORM_BATCH_SSE
+		for (; index + kLanes <= count; index += kLanes) {
+			ComposeAffineLanes(transforms, parents, globals, index);
+		}
+#endif // AOE_TRANSFORM_BATCH_SSE
+
+		for (; index < count; ++index) {
+			ComposeAffineSingle(transforms, parents, globals, index);
+		}
+	}
+
+private:
+	static constexpr size_t kMatrixSize = 16;
+	static constexpr size_t kAffineSize = 12;
+
+	// Local matrix is column major.
+	static void GetLocal(const TransformArrays& transforms, size_t index, float* local) {
+		const float x = transforms.rotation_x[index];
+		const float y = transforms.rotation_y[index];
+		const float z = transforms.rotation_z[index];
+		const float w = transforms.rotation_w[index];
+		const float sx = transforms.scale_x[index];
+		const float sy = transforms.scale_y[index];
+		const float sz = transforms.scale_z[index];
+
+		local[0] = (1.0f - 2.0f * (y * y + z * z)) * sx;
+		local[1] = 2.0f * (x * y + z * w) * sx;
+		local[2] = 2.0f * (x * z - y * w) * sx;
+		local[3] = 0.0f;
+		local[4] = 2.0f * (x * y - z * w) * sy;
+		local[5] = (1.0f - 2.0f * (x * x + z * z)) * sy;
+		local[6] = 2.0f * (y * z + x * w) * sy;
+		local[7] = 0.0f;
+		local[8] = 2.0f * (x * z + y * w) * sz;
+		local[9] = 2.0f * (y * z - x * w) * sz;
+		local[10] = (1.0f - 2.0f * (x * x + y * y)) * sz;
+		local[11] = 0.0f;
+		local[12] = transforms.position_x[index];
+		local[13] = transforms.position_y[index];
+		local[14] = transforms.position_z[index];
+		local[15] = 1.0f;
+	}
+
+	static void ComposeSingle(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t index)
+	{
+		float local[kMatrixSize];
+		GetLocal(transforms, index, local);
+
+		float* global = global_matrices + index * kMatrixSize;
+
+		if (parent_matrices == nullptr) {
+			std::memcpy(global, local, sizeof(local));
+			return;
+		}
+
+		const float* parent = parent_matrices + index * kMatrixSize;
+
+		for (size_t column = 0; column < 4; ++column) {
+			const float* local_column = local + column * 4;
+			const float translation = column == 3 ? 1.0f : 0.0f;
+
+			for (size_t row = 0; row < 3; ++row) {
+				global[column * 4 + row] = parent[row] * local_column[0]
+					+ parent[4 + row] * local_column[1]
+					+ parent[8 + row] * local_column[2]
+					+ parent[12 + row] * translation;
+			}
+
+			global[column * 4 + 3] = translation;
+		}
+	}
+
+	static void ComposeAffineSingle(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t index)
+	{
+		float local[kMatrixSize];
+		GetLocal(transforms, index, local);
+
+		float* global = global_matrices + index * kAffineSize;
+
+		if (parent_matrices == nullptr) {
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t column = 0; column < 4; ++column) {
+					global[row * 4 + column] = local[column * 4 + row];
+				}
+			}
+
+			return;
+		}
+
+		const float* parent = parent_matrices + index * kAffineSize;
+
+		for (size_t row = 0; row < 3; ++row) {
+			const float* parent_row = parent + row * 4;
+
+			for (size_t column = 0; column < 4; ++column) {
+				const float* local_column = local + column * 4;
+
+				global[row * 4 + column] = parent_row[0] * local_column[0]
+					+ parent_row[1] * local_column[1]
+					+ parent_row[2] * local_column[2]
+					+ (column == 3 ? parent_row[3] : 0.0f);
+			}
+		}
+	}
+
+#ifdef AOE_TRANSFORM_BATCH_SSE
+	static constexpr size_t kLanes = 4;
+
+	static __m128 MulAdd(__m128 lhs, __m128 rhs, __m128 addend) {
+#ifdef AOE_TRANSFORM_BATCH_FMA
+		return _mm_fmadd_ps(lhs, rhs, addend);
+#else
+		return _mm_add_ps(_mm_mul_ps(lhs, rhs), addend);
+#endif // AOE_TRANSFORM_BATCH_FMA
+	}
+
+	// Each register holds the same element of the four transforms. Local
+	// elements are stored by columns, the last column is the translation.
+	static void GetLocalLanes(const TransformArrays& transforms, size_t index, __m128 (&local)[4][3]) {
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+
+		const __m128 x = _mm_loadu_ps(transforms.rotation_x + index);
+		const __m128 y = _mm_loadu_ps(transforms.rotation_y + index);
+		const __m128 z = _mm_loadu_ps(transforms.rotation_z + index);
+		const __m128 w = _mm_loadu_ps(transforms.rotation_w + index);
+		const __m128 sx = _mm_loadu_ps(transforms.scale_x + index);
+		const __m128 sy = _mm_loadu_ps(transforms.scale_y + index);
+		const __m128 sz = _mm_loadu_ps(transforms.scale_z + index);
+
+		const __m128 x2 = _mm_mul_ps(two, x);
+		const __m128 y2 = _mm_mul_ps(two, y);
+		const __m128 z2 = _mm_mul_ps(two, z);
+		const __m128 xx = _mm_mul_ps(x2, x);
+		const __m128 yy = _mm_mul_ps(y2, y);
+		const __m128 zz = _mm_mul_ps(z2, z);
+		const __m128 xy = _mm_mul_ps(x2, y);
+		const __m128 xz = _mm_mul_ps(x2, z);
+		const __m128 yz = _mm_mul_ps(y2, z);
+		const __m128 xw = _mm_mul_ps(x2, w);
+		const __m128 yw = _mm_mul_ps(y2, w);
+		const __m128 zw = _mm_mul_ps(z2, w);
+
+		local[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+		local[0][1] = _mm_mul_ps(_mm_add_ps(xy, zw), sx);
+		local[0][2] = _mm_mul_ps(_mm_sub_ps(xz, yw), sx);
+		local[1][0] = _mm_mul_ps(_mm_sub_ps(xy, zw), sy);
+		local[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+		local[1][2] = _mm_mul_ps(_mm_add_ps(yz, xw), sy);
+		local[2][0] = _mm_mul_ps(_mm_add_ps(xz, yw), sz);
+		local[2][1] = _mm_mul_ps(_mm_sub_ps(yz, xw), sz);
+		local[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+		local[3][0] = _mm_loadu_ps(transforms.position_x + index);
+		local[3][1] = _mm_loadu_ps(transforms.position_y + index);
+		local[3][2] = _mm_loadu_ps(transforms.position_z + index);
+	}
+
+	static void ComposeLanes(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t index)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		__m128 local[4][3];
+		GetLocalLanes(transforms, index, local);
+
+		__m128 global[4][3];
+
+		if (parent_matrices == nullptr) {
+			std::memcpy(global, local, sizeof(local));
+		} else {
+			__m128 parent[4][4];
+
+			for (size_t column = 0; column < 4; ++column) {
+				for (size_t lane = 0; lane < kLanes; ++lane) {
+					parent[column][lane] = _mm_loadu_ps(parent_matrices + (index + lane) * kMatrixSize + column * 4);
+				}
+
+				_MM_TRANSPOSE4_PS(parent[column][0], parent[column][1], parent[column][2], parent[column][3]);
+			}
+
+			for (size_t column = 0; column < 4; ++column) {
+				for (size_t row = 0; row < 3; ++row) {
+					__m128 element = column == 3 ? parent[3][row] : _mm_setzero_ps();
+					element = MulAdd(parent[0][row], local[column][0], element);
+					element = MulAdd(parent[1][row], local[column][1], element);
+					element = MulAdd(parent[2][row], local[column][2], element);
+					global[column][row] = element;
+				}
+			}
+		}
+
+		for (size_t column = 0; column < 4; ++column) {
+			__m128 c0 = global[column][0];
+			__m128 c1 = global[column][1];
+			__m128 c2 = global[column][2];
+			__m128 c3 = column == 3 ? one : _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+			float* global_column = global_matrices + index * kMatrixSize + column * 4;
+			_mm_storeu_ps(global_column, c0);
+			_mm_storeu_ps(global_column + kMatrixSize, c1);
+			_mm_storeu_ps(global_column + 2 * kMatrixSize, c2);
+			_mm_storeu_ps(global_column + 3 * kMatrixSize, c3);
+		}
+	}
+
+	// Rows of the four matrices are transposed into elements and back.
+	static void ComposeAffineLanes(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t index)
+	{
+		__m128 local[4][3];
+		GetLocalLanes(transforms, index, local);
+
+		__m128 global[3][4];
+
+		if (parent_matrices == nullptr) {
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t column = 0; column < 4; ++column) {
+					global[row][column] = local[column][row];
+				}
+			}
+		} else {
+			__m128 parent[3][4];
+
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t lane = 0; lane < kLanes; ++lane) {
+					parent[row][lane] = _mm_loadu_ps(parent_matrices + (index + lane) * kAffineSize + row * 4);
+				}
+
+				_MM_TRANSPOSE4_PS(parent[row][0], parent[row][1], parent[row][2], parent[row][3]);
+			}
+
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t column = 0; column < 4; ++column) {
+					__m128 element = column == 3 ? parent[row][3] : _mm_setzero_ps();
+					element = MulAdd(parent[row][0], local[column][0], element);
+					element = MulAdd(parent[row][1], local[column][1], element);
+					element = MulAdd(parent[row][2], local[column][2], element);
+					global[row][column] = element;
+				}
+			}
+		}
+
+		for (size_t row = 0; row < 3; ++row) {
+			_MM_TRANSPOSE4_PS(global[row][0], global[row][1], global[row][2], global[row][3]);
+
+			for (size_t lane = 0; lane < kLanes; ++lane) {
+				_mm_storeu_ps(global_matrices + (index + lane) * kAffineSize + row * 4, global[row][lane]);
+			}
+		}
+	}
+#endif // AOE_TRANSFORM_BATCH_SSE
+
+#ifdef AOE_TRANSFORM_BATCH_AVX2
+	static constexpr size_t kWideLanes = 8;
+
+	static __m256 MulAdd(__m256 lhs, __m256 rhs, __m256 addend) {
+#ifdef AOE_TRANSFORM_BATCH_FMA
+		return _mm256_fmadd_ps(lhs, rhs, addend);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(lhs, rhs), addend);
+#endif // AOE_TRANSFORM_BATCH_FMA
+	}
+
+	// Same as GetLocalLanes for the eight transforms.
+	static void GetLocalWideLanes(const TransformArrays& transforms, size_t index, __m256 (&local)[4][3]) {
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+
+		const __m256 x = _mm256_loadu_ps(transforms.rotation_x + index);
+		const __m256 y = _mm256_loadu_ps(transforms.rotation_y + index);
+		const __m256 z = _mm256_loadu_ps(transforms.rotation_z + index);
+		const __m256 w = _mm256_loadu_ps(transforms.rotation_w + index);
+		const __m256 sx = _mm256_loadu_ps(transforms.scale_x + index);
+		const __m256 sy = _mm256_loadu_ps(transforms.scale_y + index);
+		const __m256 sz = _mm256_loadu_ps(transforms.scale_z + index);
+
+		const __m256 x2 = _mm256_mul_ps(two, x);
+		const __m256 y2 = _mm256_mul_ps(two, y);
+		const __m256 z2 = _mm256_mul_ps(two, z);
+		const __m256 xx = _mm256_mul_ps(x2, x);
+		const __m256 yy = _mm256_mul_ps(y2, y);
+		const __m256 zz = _mm256_mul_ps(z2, z);
+		const __m256 xy = _mm256_mul_ps(x2, y);
+		const __m256 xz = _mm256_mul_ps(x2, z);
+		const __m256 yz = _mm256_mul_ps(y2, z);
+		const __m256 xw = _mm256_mul_ps(x2, w);
+		const __m256 yw = _mm256_mul_ps(y2, w);
+		const __m256 zw = _mm256_mul_ps(z2, w);
+
+		local[0][0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+		local[0][1] = _mm256_mul_ps(_mm256_add_ps(xy, zw), sx);
+		local[0][2] = _mm256_mul_ps(_mm256_sub_ps(xz, yw), sx);
+		local[1][0] = _mm256_mul_ps(_mm256_sub_ps(xy, zw), sy);
+		local[1][1] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+		local[1][2] = _mm256_mul_ps(_mm256_add_ps(yz, xw), sy);
+		local[2][0] = _mm256_mul_ps(_mm256_add_ps(xz, yw), sz);
+		local[2][1] = _mm256_mul_ps(_mm256_sub_ps(yz, xw), sz);
+		local[2][2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+		local[3][0] = _mm256_loadu_ps(transforms.position_x + index);
+		local[3][1] = _mm256_loadu_ps(transforms.position_y + index);
+		local[3][2] = _mm256_loadu_ps(transforms.position_z + index);
+	}
+
+	// Loads the row of the eight matrices, so each register holds the same
+	// element of them. Halves are transposed as 4x4 blocks.
+	static void LoadWideRow(const float* row, __m256 (&elements)[4]) {
+		__m128 low[4];
+		__m128 high[4];
+
+		for (size_t lane = 0; lane < kLanes; ++lane) {
+			low[lane] = _mm_loadu_ps(row + lane * kAffineSize);
+			high[lane] = _mm_loadu_ps(row + (lane + kLanes) * kAffineSize);
+		}
+
+		_MM_TRANSPOSE4_PS(low[0], low[1], low[2], low[3]);
+		_MM_TRANSPOSE4_PS(high[0], high[1], high[2], high[3]);
+
+		for (size_t element = 0; element < 4; ++element) {
+			elements[element] = _mm256_insertf128_ps(_mm256_castps128_ps256(low[element]), high[element], 1);
+		}
+	}
+
+	static void StoreWideRow(float* row, const __m256 (&elements)[4]) {
+		__m128 low[4];
+		__m128 high[4];
+
+		for (size_t element = 0; element < 4; ++element) {
+			low[element] = _mm256_castps256_ps128(elements[element]);
+			high[element] = _mm256_extractf128_ps(elements[element], 1);
+		}
+
+		_MM_TRANSPOSE4_PS(low[0], low[1], low[2], low[3]);
+		_MM_TRANSPOSE4_PS(high[0], high[1], high[2], high[3]);
+
+		for (size_t lane = 0; lane < kLanes; ++lane) {
+			_mm_storeu_ps(row + lane * kAffineSize, low[lane]);
+			_mm_storeu_ps(row + (lane + kLanes) * kAffineSize, high[lane]);
+		}
+	}
+
+	static void ComposeAffineWideLanes(
+		const TransformArrays& transforms,
+		const float* parent_matrices,
+		float* global_matrices,
+		size_t index)
+	{
+		__m256 local[4][3];
+		GetLocalWideLanes(transforms, index, local);
+
+		__m256 global[3][4];
+
+		if (parent_matrices == nullptr) {
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t column = 0; column < 4; ++column) {
+					global[row][column] = local[column][row];
+				}
+			}
+		} else {
+			__m256 parent[3][4];
+
+			for (size_t row = 0; row < 3; ++row) {
+				LoadWideRow(parent_matrices + index * kAffineSize + row * 4, parent[row]);
+			}
+
+			for (size_t row = 0; row < 3; ++row) {
+				for (size_t column = 0; column < 4; ++column) {
+					__m256 element = column == 3 ? parent[row][3] : _mm256_setzero_ps();
+					element = MulAdd(parent[row][0], local[column][0], element);
+					element = MulAdd(parent[row][1], local[column][1], element);
+					element = MulAdd(parent[row][2], local[column][2], element);
+					global[row][column] = element;
+				}
+			}
+		}
+
+		for (size_t row = 0; row < 3; ++row) {
+			StoreWideRow(global_matrices + index * kAffineSize + row * 4, global[row]);
+		}
+	}
+#endif // AOE_TRANSFORM_BATCH_AVX2
+};
+
+} // namespace aoe
\ No newline at end of file
@@ -1,7 +0,0 @@
-#pragma once
-
-namespace aoe {
-
-struct TransformChangedComponent{};
-
-} // namespace aoe
\ No newline at end of file
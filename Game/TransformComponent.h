@@ -25,7 +25,7 @@ public:
 
 	TransformComponent(Transform transform)
 		: transform_(transform)
-		, global_world_matrix_(Matrix4f::Identity())
+		, global_world_matrix_(Affine3x4f::Identity())
 		, has_changed_(true)
 	{}
 
@@ -78,16 +78,16 @@ public:
 		return has_changed_;
 	}
 
-	const Matrix4f& GetGlobalWorldMatrix() const {
+	const Affine3x4f& GetGlobalWorldMatrix() const {
 		return global_world_matrix_;
 	}
 
 private:
 	Transform transform_;
-	Matrix4f global_world_matrix_;
+	Affine3x4f global_world_matrix_;
 	bool has_changed_;
 
-	void SetGlobalWorldMatrix(const Matrix4f& value) {
+	void SetGlobalWorldMatrix(const Affine3x4f& value) {
 		global_world_matrix_ = value;
 		has_changed_ = false;
 	}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
+#include <vector>
+
 #include "ECSSystemBase.h"
 #include "Relationeer.h"
+#include "TransformBatch.h"
 #include "TransformComponent.h"
-#include "TransformChangedComponent.h"
 
 namespace aoe {
 
@@ -14,61 +18,208 @@ public:
 
 		relationeer_ = service_provider.TryGetService<Relationeer<TransformComponent>>();
 		AOE_ASSERT_MSG(relationeer_ != nullptr, "There is no Relationeer<TransformComponent> service.");
+
+		relationeer_->ParentChanged.Attach(*this, &TransformSystem::OnParentChanged);
+	}
+
+	void Terminate() override {
+		relationeer_->ParentChanged.Detach(*this, &TransformSystem::OnParentChanged);
 	}
 
+	// Global matrices are up to date at the tick of the update, later changes
+	// are marked with the next one.
 	void Update(float dt) override {
-		RemoveNotificationComponents();
 		UpdateTransformComponents();
+
+		World* world = GetWorld();
+		relationeer_->SetSyncTick(world->GetChangeTick());
+		world->IncrementChangeTick();
 	}
 
 private:
-	Relationeer<TransformComponent>* relationeer_;
+	using HierarchyNode = Relationeer<TransformComponent>::HierarchyNode;
+
+	static constexpr size_t kParallelBatchSize = 256;
+	static constexpr size_t kComposeBatchSize = 64;
+
+	// State of the updated node, which is read by the children.
+	struct NodeState {
+		const Affine3x4f* global_world_matrix;
+		bool has_changed;
+	};
+
+	// Changed nodes in the structure of arrays layout of the TransformBatch.
+	struct ComposeBatch {
+		float position_x[kComposeBatchSize];
+		float position_y[kComposeBatchSize];
+		float position_z[kComposeBatchSize];
+		float rotation_x[kComposeBatchSize];
+		float rotation_y[kComposeBatchSize];
+		float rotation_z[kComposeBatchSize];
+		float rotation_w[kComposeBatchSize];
+		float scale_x[kComposeBatchSize];
+		float scale_y[kComposeBatchSize];
+		float scale_z[kComposeBatchSize];
+		Affine3x4f parents[kComposeBatchSize];
+		Affine3x4f globals[kComposeBatchSize];
+		TransformComponent* components[kComposeBatchSize];
+		size_t indices[kComposeBatchSize];
+
+		void Add(size_t slot, TransformComponent& component, const Affine3x4f& parent, size_t index) {
+			const Transform& transform = component.GetTransform();
+			const Vector3f rotation = transform.rotation.vector();
+
+			position_x[slot] = transform.position[0];
+			position_y[slot] = transform.position[1];
+			position_z[slot] = transform.position[2];
+			rotation_x[slot] = rotation[0];
+			rotation_y[slot] = rotation[1];
+			rotation_z[slot] = rotation[2];
+			rotation_w[slot] = transform.rotation.scalar();
+			scale_x[slot] = transform.scale[0];
+			scale_y[slot] = transform.scale[1];
+			scale_z[slot] = transform.scale[2];
+			parents[slot] = parent;
+			components[slot] = &component;
+			indices[slot] = index;
+		}
 
-	void RemoveNotificationComponents() {
-		for (Entity entity : FilterEntities<TransformChangedComponent>()) {
-			RemoveComponent<TransformChangedComponent>(entity);
+		TransformArrays GetArrays() const {
+			return {
+				position_x, position_y, position_z,
+				rotation_x, rotation_y, rotation_z, rotation_w,
+				scale_x, scale_y, scale_z,
+			};
 		}
+	};
+
+	Relationeer<TransformComponent>* relationeer_;
+	std::vector<NodeState> states_;
+	std::vector<Entity> order_;
+	std::span<TransformComponent> components_;
+
+	// Global matrix is stale until the next update.
+	void OnParentChanged(Entity entity) {
+		auto transform_component = GetComponent<TransformComponent>(entity);
+		transform_component->has_changed_ = true;
 	}
 
 	void UpdateTransformComponents() {
-		const Matrix4f origin = Matrix4f::Identity();
+		const std::vector<HierarchyNode>& hierarchy = relationeer_->GetHierarchy();
+		ThreadPool* thread_pool = GetThreadPool();
+		states_.resize(hierarchy.size());
+		components_ = ArrangeTransformComponents(hierarchy);
+
+		for (size_t level = 0; level < relationeer_->GetLevelsCount(); ++level) {
+			size_t begin = relationeer_->GetLevelBegin(level);
+			size_t end = relationeer_->GetLevelEnd(level);
 
-		for (Entity entity : FilterEntities<TransformComponent>()) {
-			if (relationeer_->IsRoot(entity)) {
-				UpdateTransformComponents(entity, origin, false);
+			if (thread_pool != nullptr && end - begin > kParallelBatchSize) {
+				thread_pool->ParallelFor(end - begin, kParallelBatchSize, [&](size_t batch_begin, size_t batch_end) {
+					UpdateTransformComponents(hierarchy, begin + batch_begin, begin + batch_end);
+				});
+			} else {
+				UpdateTransformComponents(hierarchy, begin, end);
 			}
 		}
 	}
 
+	// Dense storage is kept in the hierarchy order, so the pass reads the
+	// components linearly. It's rearranged only after the hierarchy or the
+	// pool order changes. Returns empty span if the components are looked up.
+	std::span<TransformComponent> ArrangeTransformComponents(const std::vector<HierarchyNode>& hierarchy) {
+		World* world = GetWorld();
+
+		if (world->GetStorage() != WorldStorage::kSparseSet) {
+			return {};
+		}
+
+		std::span<const Entity> entities = world->GetDenseEntities<TransformComponent>();
+
+		if (entities.size() != hierarchy.size()) {
+			return {};
+		}
+
+		bool is_arranged = std::equal(entities.begin(), entities.end(), hierarchy.begin(), [](Entity entity, const HierarchyNode& node) {
+			return entity == node.entity;
+		});
+
+		if (!is_arranged) {
+			order_.clear();
+
+			for (const HierarchyNode& node : hierarchy) {
+				order_.push_back(node.entity);
+			}
+
+			world->Arrange<TransformComponent>(order_);
+		}
+
+		return world->GetDenseComponents<TransformComponent>();
+	}
+
 	void UpdateTransformComponents(
-		Entity entity, 
-		const Matrix4f& transformation,
-		bool has_changed) 
+		const std::vector<HierarchyNode>& hierarchy,
+		size_t begin,
+		size_t end)
 	{
-		auto transform_component = GetComponent<TransformComponent>(entity);
-		has_changed |= transform_component->HasChanged();
-		
-		if (has_changed) {
-			UpdateTransformComponent(entity, transform_component, transformation);
+		for (size_t batch_begin = begin; batch_begin < end; batch_begin += kComposeBatchSize) {
+			size_t batch_end = std::min(batch_begin + kComposeBatchSize, end);
+			UpdateTransformComponentsBatch(hierarchy, batch_begin, batch_end);
+		}
+	}
+
+	// Changed nodes are gathered into arrays, composed by the TransformBatch
+	// and written back. Nodes of the range are of the same level, so they
+	// don't read each other matrices.
+	void UpdateTransformComponentsBatch(
+		const std::vector<HierarchyNode>& hierarchy,
+		size_t begin,
+		size_t end)
+	{
+		static const Affine3x4f origin = Affine3x4f::Identity();
+
+		// Batch is per thread, since the level ranges are updated in parallel.
+		static thread_local ComposeBatch batch;
+		size_t count = 0;
+
+		for (size_t index = begin; index < end; ++index) {
+			const HierarchyNode& node = hierarchy[index];
+			NodeState& state = states_[index];
+			const Affine3x4f* transformation = &origin;
+
+			TransformComponent& transform_component = GetTransformComponent(node.entity, index);
+			state.has_changed = transform_component.HasChanged();
+			state.global_world_matrix = &transform_component.global_world_matrix_;
+
+			if (node.parent_index != Relationeer<TransformComponent>::kNoParent) {
+				const NodeState& parent_state = states_[node.parent_index];
+				state.has_changed |= parent_state.has_changed;
+				transformation = parent_state.global_world_matrix;
+			}
+
+			if (state.has_changed) {
+				batch.Add(count, transform_component, *transformation, index);
+				count += 1;
+			}
 		}
 
-		const Matrix4f& global_world_matrix = transform_component->global_world_matrix_;
+		TransformBatch::Compose(batch.GetArrays(), batch.parents, batch.globals, count);
 
-		for (Entity children : relationeer_->GetChildren(entity)) {
-			UpdateTransformComponents(children, global_world_matrix, has_changed);
+		for (size_t slot = 0; slot < count; ++slot) {
+			batch.components[slot]->SetGlobalWorldMatrix(batch.globals[slot]);
+			GetWorld()->MarkChanged<TransformComponent>(hierarchy[batch.indices[slot]].entity);
 		}
 	}
 
-	void UpdateTransformComponent(
-		Entity entity,
-		CH<TransformComponent> transform_component, 
-		const Matrix4f& transformation)
-	{
-		const Matrix4f world_matrix = transform_component->GetWorldMatrix();
-		const Matrix4f global_world_matrix = transformation * world_matrix;
+	// Read only access doesn't mark the component as changed, the updated
+	// ones are marked explicitly.
+	TransformComponent& GetTransformComponent(Entity entity, size_t index) {
+		if (!components_.empty()) {
+			return components_[index];
+		}
 
-		transform_component->SetGlobalWorldMatrix(global_world_matrix);
-		AddComponent<TransformChangedComponent>(entity);
+		const auto transform_component = GetComponent<TransformComponent>(entity);
+		return const_cast<TransformComponent&>(*transform_component.Get());
 	}
 };
 
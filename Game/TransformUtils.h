@@ -16,18 +16,13 @@ public:
 		Relationeer<TransformComponent>& relationeer,
 		Entity entity)
 	{
-		auto transform_component = world.GetComponent<TransformComponent>(entity);
+		const auto transform_component = world.GetComponent<TransformComponent>(entity);
 
 		if (relationeer.IsRoot(entity)) {
 			return transform_component->GetTransform();
 		}
 
-		Entity parent = relationeer.GetParent(entity);
-		Matrix4f local_world_matrix = transform_component->GetWorldMatrix();
-		Matrix4f parent_world_matrix = GetGlobalWorldMatrix(world, relationeer, parent);
-		Matrix4f global_world_matrix = parent_world_matrix * local_world_matrix;
-
-		return global_world_matrix;
+		return GetGlobalWorldMatrix(world, relationeer, entity);
 	}
 
 	static void SetGlobalTransform(
@@ -44,11 +39,11 @@ public:
 		}
 
 		Entity parent = relationeer.GetParent(entity);
-		Matrix4f global_world_matrix = transform.ToMatrix();
-		Matrix4f parent_world_matrix = GetGlobalWorldMatrix(world, relationeer, parent);
-		Matrix4f local_world_matrix = parent_world_matrix.Inverse() * global_world_matrix;
+		Affine3x4f global_world_matrix = transform.ToAffine();
+		Affine3x4f parent_world_matrix = GetGlobalAffine(world, relationeer, parent);
+		Affine3x4f local_world_matrix = parent_world_matrix.Inverse() * global_world_matrix;
 
-		transform_component->SetWorldMatrix(local_world_matrix);
+		transform_component->SetWorldMatrix(local_world_matrix.ToMatrix4());
 	}
 
 	static Vector3f GetGlobalPosition(
@@ -56,14 +51,14 @@ public:
 		Relationeer<TransformComponent>& relationeer,
 		Entity entity)
 	{
-		auto transform_component = world.GetComponent<TransformComponent>(entity);
+		const auto transform_component = world.GetComponent<TransformComponent>(entity);
 
 		if (relationeer.IsRoot(entity)) {
 			return transform_component->GetPosition();
 		}
 
 		Entity parent = relationeer.GetParent(entity);
-		Matrix4f parent_world_matrix = GetGlobalWorldMatrix(world, relationeer, parent);
+		Affine3x4f parent_world_matrix = GetGlobalAffine(world, relationeer, parent);
 		return parent_world_matrix * transform_component->GetPosition();
 	}
 
@@ -81,7 +76,7 @@ public:
 		}
 
 		Entity parent = relationeer.GetParent(entity);
-		Matrix4f parent_world_matrix = GetGlobalWorldMatrix(world, relationeer, parent);
+		Affine3x4f parent_world_matrix = GetGlobalAffine(world, relationeer, parent);
 		transform_component->SetPosition(parent_world_matrix.Inverse() * position);
 	}
 
@@ -90,15 +85,15 @@ public:
 		Relationeer<TransformComponent>& relationeer,
 		Entity entity)
 	{
-		auto transform_component = world.GetComponent<TransformComponent>(entity);
+		const auto transform_component = world.GetComponent<TransformComponent>(entity);
 
 		if (relationeer.IsRoot(entity)) {
 			return transform_component->GetRotation();
 		}
 
 		Entity parent = relationeer.GetParent(entity);
-		Quaternion parent_rotation = GetGlobalRotation(world, relationeer, parent);
-		return parent_rotation * transform_component->GetRotation();
+		Affine3x4f parent_world_matrix = GetGlobalAffine(world, relationeer, parent);
+		return GetRotation(parent_world_matrix) * transform_component->GetRotation();
 	}
 
 	static void SetGlobalRotation(
@@ -115,8 +110,8 @@ public:
 		}
 
 		Entity parent = relationeer.GetParent(entity);
-		Quaternion parent_rotation = GetGlobalRotation(world, relationeer, parent);
-		transform_component->SetRotation(parent_rotation.Inverse() * rotation);
+		Affine3x4f parent_world_matrix = GetGlobalAffine(world, relationeer, parent);
+		transform_component->SetRotation(GetRotation(parent_world_matrix).Inverse() * rotation);
 	}
 
 	static Matrix4f GetGlobalWorldMatrix(
@@ -124,16 +119,110 @@ public:
 		Relationeer<TransformComponent>& relationeer,
 		Entity entity)
 	{
-		auto transform_component = world.GetComponent<TransformComponent>(entity);
-		const Matrix4f& world_matrix = transform_component->GetWorldMatrix();
+		return GetGlobalAffine(world, relationeer, entity).ToMatrix4();
+	}
+
+	// Returns the matrix computed by the TransformSystem if transforms haven't
+	// changed since, otherwise the chain is composed once per change and
+	// memoized until the next one.
+	static Affine3x4f GetGlobalAffine(
+		World& world,
+		Relationeer<TransformComponent>& relationeer,
+		Entity entity)
+	{
+		if (world.GetLastChangeTick<TransformComponent>() <= relationeer.GetSyncTick()) {
+			const auto transform_component = world.GetComponent<TransformComponent>(entity);
+			return transform_component->GetGlobalWorldMatrix();
+		}
+
+		SparseMap<ComposedMatrix>& memo = GetMemo(world);
+		return ComposeGlobalWorldMatrix(world, relationeer, memo, entity).world_matrix;
+	}
+
+private:
+	struct ComposedMatrix {
+		Affine3x4f world_matrix;
+		bool has_changed;
+
+		ComposedMatrix(const Affine3x4f& world_matrix, bool has_changed)
+			: world_matrix(world_matrix)
+			, has_changed(has_changed)
+		{}
+	};
+
+	// Composed matrices are valid while transforms are unchanged since the tick.
+	struct Memo {
+		const World* world;
+		ChangeTick tick;
+		SparseMap<ComposedMatrix> matrices;
+	};
+
+	// Memo is per thread, so the parallel readers don't share it.
+	inline static thread_local Memo memo_ = { nullptr, 0, {} };
+
+	// The change tick is incremented on reset, so the later changes are
+	// distinguished from the memoized state.
+	static SparseMap<ComposedMatrix>& GetMemo(World& world) {
+		bool is_valid = memo_.world == &world
+			&& world.GetChangeTick() > memo_.tick
+			&& world.GetLastChangeTick<TransformComponent>() <= memo_.tick;
+
+		if (!is_valid) {
+			memo_.world = &world;
+			memo_.tick = world.GetChangeTick();
+			memo_.matrices.Clear();
+			world.IncrementChangeTick();
+		}
+
+		return memo_.matrices;
+	}
+
+	// Matrix computed by the TransformSystem is reused if neither the entity
+	// nor its ancestors have changed since.
+	static const ComposedMatrix& ComposeGlobalWorldMatrix(
+		World& world,
+		Relationeer<TransformComponent>& relationeer,
+		SparseMap<ComposedMatrix>& memo,
+		Entity entity)
+	{
+		if (memo.Has(entity.GetId())) {
+			return memo.Get(entity.GetId());
+		}
+
+		const auto transform_component = world.GetComponent<TransformComponent>(entity);
+		bool has_changed = transform_component->HasChanged();
+		Affine3x4f world_matrix = transform_component->GetGlobalWorldMatrix();
 
 		if (relationeer.IsRoot(entity)) {
-			return world_matrix;
+			if (has_changed) {
+				world_matrix = transform_component->GetTransform().ToAffine();
+			}
+		} else {
+			const ComposedMatrix& parent = ComposeGlobalWorldMatrix(world, relationeer, memo, relationeer.GetParent(entity));
+			has_changed |= parent.has_changed;
+
+			if (has_changed) {
+				world_matrix = parent.world_matrix * transform_component->GetTransform().ToAffine();
+			}
 		}
 
-		Entity parent = relationeer.GetParent(entity);
-		Matrix4f parent_world_matrix = GetGlobalWorldMatrix(world, relationeer, parent);
-		return parent_world_matrix * world_matrix;
+		memo.Emplace(entity.GetId(), world_matrix, has_changed);
+		return memo.Get(entity.GetId());
+	}
+
+	// Scale is removed from the basis before the conversion. Basis of the
+	// sheared matrix isn't orthogonal, so the rotation is renormalized.
+	static Quaternion GetRotation(const Affine3x4f& world_matrix) {
+		Vector3f axis_x = Vector3f(world_matrix(0, 0), world_matrix(1, 0), world_matrix(2, 0)).Normalized();
+		Vector3f axis_y = Vector3f(world_matrix(0, 1), world_matrix(1, 1), world_matrix(2, 1)).Normalized();
+		Vector3f axis_z = Vector3f(world_matrix(0, 2), world_matrix(1, 2), world_matrix(2, 2)).Normalized();
+
+		Matrix3f rotation_matrix(
+			axis_x[0], axis_x[1], axis_x[2],
+			axis_y[0], axis_y[1], axis_y[2],
+			axis_z[0], axis_z[1], axis_z[2]);
+
+		return Quaternion::FromMatrix(rotation_matrix).Normalized();
 	}
 };
 
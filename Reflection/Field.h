@@ -24,6 +24,10 @@ public:
 		return name_;
 	}
 
+	const Type* GetType() const {
+		return type_;
+	}
+
 	void* GetValue(void* object) const {
 		return getter_(object);
 	}
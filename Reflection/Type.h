@@ -15,11 +15,15 @@ public:
 	Type(
 		TypeId type_id,
 		std::string name,
+		size_t size,
+		bool is_trivially_copyable,
 		std::vector<const Field*> fields,
 		std::vector<const Type*> base_classes,
 		std::function<void* ()> constructor)
 		: type_id_(type_id)
 		, name_(std::move(name))
+		, size_(size)
+		, is_trivially_copyable_(is_trivially_copyable)
 		, fields_(std::move(fields))
 		, base_classes_(std::move(base_classes))
 		, constructor_(constructor)
@@ -36,6 +40,14 @@ public:
 		return name_;
 	}
 
+	size_t GetSize() const {
+		return size_;
+	}
+
+	bool IsTriviallyCopyable() const {
+		return is_trivially_copyable_;
+	}
+
 	const std::vector<const Type*>& GetBaseClasses() const {
 		return base_classes_;
 	}
@@ -74,6 +86,8 @@ public:
 private:
 	TypeId type_id_;
 	std::string name_;
+	size_t size_;
+	bool is_trivially_copyable_;
 	std::vector<const Field*> fields_;
 	std::vector<const Type*> base_classes_;
 	std::function<void* ()> constructor_;
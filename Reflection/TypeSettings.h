@@ -1,5 +1,6 @@
 #pragma once
 
+#include <type_traits>
 #include <vector>
 
 #include "../Core/Debug.h"
@@ -41,7 +42,7 @@ public:
 	const Type* Register() {
 		std::string name(TypeName<T>());
 		auto type_id = Identifier::GetTypeId<T>();
-		auto* type = new Type(type_id, name, fields, base_classes, constructor_);
+		auto* type = new Type(type_id, name, sizeof(T), std::is_trivially_copyable_v<T>, fields, base_classes, constructor_);
 		Reflector::Register<T>(type);
 		return type;
 	}
@@ -10,11 +10,8 @@ bool CameraUtils::HasCamera(World& world) {
 }
 
 Entity CameraUtils::GetActualCamera(World& world) {
-	for (Entity camera : world.FilterEntities<TransformComponent, DX11CameraComponent>()) {
-		return camera;
-	}
-	
-	return Entity::Null();
+	const auto& cameras = world.GetQuery<TransformComponent, DX11CameraComponent>();
+	return cameras.IsEmpty() ? Entity::Null() : *cameras.begin();
 }
 
 Matrix4f CameraUtils::GetProjectionMatrix(World& world, Entity camera) {
@@ -3,8 +3,8 @@ struct CameraData {
 };
 
 struct TransformData {
-    float4x4 world;
-    float4x4 world_it;
+    row_major float3x4 world;
+    row_major float3x4 world_it;
 };
 
 struct MaterialData {
@@ -50,15 +50,15 @@ struct PixelOut {
 };
 
 PixelIn VertexMain(VertexIn input) {
-    float4x4 world_view_projection = mul(Transform.world, Camera.view_projection);
     float4 position = float4(input.position, 1.0);
     float4 normal = float4(input.normal, 0.0);
+    float4 world_position = float4(mul(Transform.world, position), 1.0);
     
     PixelIn output;
-    output.position = mul(position, world_view_projection);
-    output.normal = mul(normal, Transform.world_it);
+    output.position = mul(world_position, Camera.view_projection);
+    output.normal = float4(mul(Transform.world_it, normal), 0.0);
     output.uv = input.uv;
-    output.world_position = mul(position, Transform.world);
+    output.world_position = world_position;
     
     return output;
 }
@@ -1,12 +1,13 @@
 #pragma once
 
+#include "../Core/Affine3x4f.h"
 #include "../Core/Math.h"
 
 namespace aoe {
 
 struct TransformData {
-	Matrix4f world;
-	Matrix4f world_it;
+	Affine3x4f world;
+	Affine3x4f world_it;
 };
 
 struct MaterialData {
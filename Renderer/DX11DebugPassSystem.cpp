@@ -1,7 +1,5 @@
 #include "pch.h"
 
-#include "../Game/TransformChangedComponent.h"
-
 #include "DX11DebugPassSystem.h"
 #include "DX11RenderData.h"
 #include "DX11ShaderHelper.h"
@@ -23,11 +21,11 @@ void DX11DebugPassSystem::Update(float dt) {
 }
 
 void DX11DebugPassSystem::UpdateRenderData() {
-	for (Entity entity : FilterEntities<TransformComponent, TransformChangedComponent, DX11LineComponent>()) {
-		auto transform_component = GetComponent<TransformComponent>(entity);
+	for (Entity entity : FilterEntities<Changed<TransformComponent>, DX11LineComponent>()) {
+		const auto transform_component = GetComponent<TransformComponent>(entity);
 		auto line_component = GetComponent<DX11LineComponent>(entity);
 
-		const Matrix4f& world = transform_component->GetGlobalWorldMatrix();
+		const Matrix4f world = transform_component->GetGlobalWorldMatrix().ToMatrix4();
 		const Matrix4f world_t = world.Transpose();
 
 		line_component->transform_data_.Update(&world_t);
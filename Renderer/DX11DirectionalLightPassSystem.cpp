@@ -1,7 +1,5 @@
 #include "pch.h"
 
-#include "../Game/TransformChangedComponent.h"
-
 #include "DX11DirectionalLightPassSystem.h"
 #include "DX11ShaderHelper.h"
 #include "DX11DirectionalLightComponent.h"
@@ -22,8 +20,8 @@ void DX11DirectionalLightPassSystem::Update(float dt) {
 }
 
 void DX11DirectionalLightPassSystem::UpdateRenderData() {
-	for (Entity entity : FilterEntities<TransformComponent, TransformChangedComponent, DX11DirectionalLightComponent>()) {
-		auto transform_component = GetComponent<TransformComponent>(entity);
+	for (Entity entity : FilterEntities<Changed<TransformComponent>, DX11DirectionalLightComponent>()) {
+		const auto transform_component = GetComponent<TransformComponent>(entity);
 		auto directional_light_component = GetComponent<DX11DirectionalLightComponent>(entity);
 
 		const Vector3f forward = transform_component->GetGlobalWorldMatrix() * Math::kForward;
@@ -1,7 +1,5 @@
 #include "pch.h"
 
-#include "../Game/TransformChangedComponent.h"
-
 #include "DX11GeometryPassSystem.h"
 #include "DX11RenderData.h"
 #include "DX11BufferModels.h"
@@ -58,15 +56,15 @@ GPUBlendStateDescription DX11GeometryPassSystem::CreateBlendStateDescription() {
 }
 
 void DX11GeometryPassSystem::UpdateRenderData() {
-	for (Entity entity : FilterEntities<TransformComponent, TransformChangedComponent, DX11RenderComponent>()) {
-		auto transform_component = GetComponent<TransformComponent>(entity);
+	for (Entity entity : FilterEntities<Changed<TransformComponent>, DX11RenderComponent>()) {
+		const auto transform_component = GetComponent<TransformComponent>(entity);
 		auto render_component = GetComponent<DX11RenderComponent>(entity);
 
-		const Matrix4f& world = transform_component->GetGlobalWorldMatrix();
+		const Affine3x4f& world = transform_component->GetGlobalWorldMatrix();
 
 		TransformData transform_data{};
-		transform_data.world = world.Transpose();
-		transform_data.world_it = world.Inverse();
+		transform_data.world = world;
+		transform_data.world_it = world.GetNormalMatrix();
 
 		render_component->transform_data_.Update(&transform_data);
 	}
@@ -79,22 +77,45 @@ void DX11GeometryPassSystem::Render(Entity camera) {
 	auto camera_component = GetComponent<DX11CameraComponent>(camera);
 	context.SetConstantBuffer(GPUShaderType::kVertex, camera_component->GetCameraData().buffer, 0);
 
-	for (Entity entity : FilterEntities<TransformComponent, DX11RenderComponent>()) {
-		auto render_component = GetComponent<DX11RenderComponent>(entity);
-		
-		const DX11ModelResources& model_resources = model_manager_->GetModelResources(render_component->GetModelId());
-		const DX11GPUTexture2D& texture_resources = texture_manager_->GetTextureResources(render_component->GetTextureId());
+	auto& renderables = GetGroup<TransformComponent, DX11RenderComponent>();
+
+	// Entities of the same model and texture form runs, so the state is bound once per run.
+	renderables.Sort<DX11RenderComponent>([](const DX11RenderComponent& lhs, const DX11RenderComponent& rhs) {
+		if (lhs.GetModelId() != rhs.GetModelId()) {
+			return lhs.GetModelId() < rhs.GetModelId();
+		}
+
+		return lhs.GetTextureId() < rhs.GetTextureId();
+	});
+
+	const DX11ModelResources* bound_model = nullptr;
+	const DX11GPUTexture2D* bound_texture = nullptr;
 
-		context.SetConstantBuffer(GPUShaderType::kVertex, render_component->GetTransformData().buffer, 1);
-		context.SetConstantBuffer(GPUShaderType::kPixel, render_component->GetMaterialData().buffer, 2);
-		context.SetShaderResource(GPUShaderType::kPixel, texture_resources.GetTextureView(), 0);
+	renderables.ForEach([&](Entity entity, const TransformComponent& transform_component, const DX11RenderComponent& render_component) {
+		const DX11ModelResources& model_resources = model_manager_->GetModelResources(render_component.GetModelId());
+		const DX11GPUTexture2D& texture_resources = texture_manager_->GetTextureResources(render_component.GetTextureId());
+
+		context.SetConstantBuffer(GPUShaderType::kVertex, render_component.GetTransformData().buffer, 1);
+		context.SetConstantBuffer(GPUShaderType::kPixel, render_component.GetMaterialData().buffer, 2);
+
+		if (bound_texture != &texture_resources) {
+			context.SetShaderResource(GPUShaderType::kPixel, texture_resources.GetTextureView(), 0);
+			bound_texture = &texture_resources;
+		}
+
+		// Buffers of the single mesh model stay bound for the whole run.
+		bool is_bound = bound_model == &model_resources && model_resources.meshes_resources.size() == 1;
+		bound_model = &model_resources;
 
 		for (const DX11MeshResources& mesh_resource : model_resources.meshes_resources) {
-			context.SetVertexBuffer(mesh_resource.vertex_buffer);
-			context.SetIndexBuffer(mesh_resource.index_buffer);
+			if (!is_bound) {
+				context.SetVertexBuffer(mesh_resource.vertex_buffer);
+				context.SetIndexBuffer(mesh_resource.index_buffer);
+			}
+
 			context.DrawIndexed(mesh_resource.index_buffer.GetElementsCount());
 		}
-	}
+	});
 }
 
 void DX11GeometryPassSystem::PrepareRenderContext() {
@@ -1,7 +1,5 @@
 #include "pch.h"
 
-#include "../Game/TransformChangedComponent.h"
-
 #include "DX11PointLightPassSystem.h"
 #include "DX11ShaderHelper.h"
 #include "DX11PointLightComponent.h"
@@ -33,8 +31,8 @@ void DX11PointLightPassSystem::Update(float dt) {
 }
 
 void DX11PointLightPassSystem::UpdateRenderData() {
-	for (Entity entity : FilterEntities<TransformComponent, TransformChangedComponent, DX11PointLightComponent>()) {
-		auto transform_component = GetComponent<TransformComponent>(entity);
+	for (Entity entity : FilterEntities<Changed<TransformComponent>, DX11PointLightComponent>()) {
+		const auto transform_component = GetComponent<TransformComponent>(entity);
 		auto point_light_component = GetComponent<DX11PointLightComponent>(entity);
 
 		const Matrix4f world = GetGlobalWorldMatrix(entity);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../ECS/ComponentTraits.h"
 #include "../Resources/Resources.h"
 
 #include "Material.h"
@@ -76,4 +77,10 @@ private:
 	}
 };
 
+// Render components may be cached by pointer.
+template<>
+struct ComponentTraits<DX11RenderComponent> {
+	static constexpr bool kIsStable = true;
+};
+
 } // namespace aoe
\ No newline at end of file
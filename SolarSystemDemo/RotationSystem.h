@@ -7,19 +7,25 @@
 
 class RotationSystem : public aoe::ECSSystemBase {
 public:
+	RotationSystem() {
+		Writes<aoe::TransformComponent>();
+		Reads<RotationComponent>();
+	}
+
 	void Update(float dt) override {
 		using namespace aoe;
 
-		for (Entity entity : FilterEntities<TransformComponent, RotationComponent>()) {
-			auto transform_component = GetComponent<TransformComponent>(entity);
-			auto rotation_component = GetComponent<RotationComponent>(entity);
-
+		ParallelForEach<TransformComponent, RotationComponent>([](
+			Entity entity,
+			TransformComponent& transform_component,
+			const RotationComponent& rotation_component)
+		{
 			Quaternion rotator = Quaternion::FromAngleAxis(
-				rotation_component->speed * Math::kDeg2Rad, 
-				rotation_component->axis);
+				rotation_component.speed * Math::kDeg2Rad, 
+				rotation_component.axis);
 			
-			Quaternion rotation = rotator * transform_component->GetRotation();
-			transform_component->SetRotation(rotation);
-		}
+			Quaternion rotation = rotator * transform_component.GetRotation();
+			transform_component.SetRotation(rotation);
+		});
 	}
 };
\ No newline at end of file